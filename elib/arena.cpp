@@ -0,0 +1,319 @@
+/*
+  ELib
+
+  Region allocation
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "elib.h"
+#include "../hal/hal_platform.h"
+#include "arena.h"
+
+//
+// Block header. The usable space follows the header, which is padded out so
+// that the first allocation in a block is maximally aligned.
+//
+struct EArena::block_t
+{
+    block_t *prev; // next older block
+    size_t   size; // usable bytes in this block
+    size_t   used; // bytes handed out so far
+
+    ebyte *data() { return reinterpret_cast<ebyte *>(this) + HEADER_SIZE; }
+    const ebyte *data() const { return reinterpret_cast<const ebyte *>(this) + HEADER_SIZE; }
+
+    static const size_t HEADER_SIZE;
+};
+
+const size_t EArena::block_t::HEADER_SIZE =
+    (sizeof(EArena::block_t) + EArena::DEFAULT_ALIGNMENT - 1) & ~(EArena::DEFAULT_ALIGNMENT - 1);
+
+//
+// Blocks always come from the heap, even while this or another arena is
+// receiving routed zone allocations on the current thread.
+//
+static void *ArenaHeapAlloc(size_t size)
+{
+    EArena *const prev = E_SetCurrentArena(nullptr);
+    void   *const ret  = E_Malloc(size);
+    E_SetCurrentArena(prev);
+    return ret;
+}
+
+static void ArenaHeapFree(void *ptr)
+{
+    EArena *const prev = E_SetCurrentArena(nullptr);
+    E_Free(ptr);
+    E_SetCurrentArena(prev);
+}
+
+//
+// Get a block with at least minSize usable bytes and make it the head.
+//
+EArena::block_t *EArena::newBlock(size_t minSize)
+{
+    block_t *block;
+
+    if(m_spare && m_spare->size >= minSize)
+    {
+        block   = m_spare;
+        m_spare = nullptr;
+    }
+    else
+    {
+        const size_t size = emax(minSize, m_blockSize);
+        block = static_cast<block_t *>(ArenaHeapAlloc(block_t::HEADER_SIZE + size));
+        block->size = size;
+    }
+
+    block->prev = m_head;
+    block->used = 0;
+    m_head = block;
+
+    return block;
+}
+
+//
+// Return a block to the zone heap, or keep it as the spare if it is a
+// standard-sized block and there is no spare yet.
+//
+void EArena::freeBlock(block_t *block)
+{
+    if(!m_spare && block->size == m_blockSize)
+        m_spare = block;
+    else
+        ArenaHeapFree(block);
+}
+
+//
+// Allocate size bytes at the requested alignment, which must be a power of
+// two. Memory is not cleared.
+//
+void *EArena::alloc(size_t size, size_t alignment)
+{
+    eassert(alignment && !(alignment & (alignment - 1)));
+
+    // Every allocation takes at least a byte, so that owns() recognizes one
+    // made at the top of a block.
+    if(!size)
+        size = 1;
+
+    block_t *block = m_head;
+    size_t   offset = 0;
+
+    if(block)
+    {
+        const uintptr_t top = reinterpret_cast<uintptr_t>(block->data()) + block->used;
+        offset = block->used + (((top + alignment - 1) & ~uintptr_t(alignment - 1)) - top);
+    }
+
+    if(!block || offset + size > block->size)
+    {
+        // over-allocate by the alignment so that any request can be satisfied
+        block = newBlock(size + alignment);
+
+        const uintptr_t top = reinterpret_cast<uintptr_t>(block->data());
+        offset = ((top + alignment - 1) & ~uintptr_t(alignment - 1)) - top;
+    }
+
+    void *const ret = block->data() + offset;
+    block->used = offset + size;
+    m_last = ret;
+
+    return ret;
+}
+
+//
+// Allocate zero-filled memory for count objects of the given size.
+//
+void *EArena::calloc(size_t count, size_t size)
+{
+    const size_t total = count * size;
+    if(size && total / size != count)
+        hal_platform.fatalError("EArena::calloc: overflow on allocation of %zu objects", count);
+
+    return std::memset(alloc(total), 0, total);
+}
+
+//
+// Resize an allocation previously made from this arena. The most recent
+// allocation is resized in place when it fits; anything else is moved. Since
+// arena allocations carry no size, the copy is bounded by the space between
+// the pointer and the top of its block, which always covers the old size.
+//
+void *EArena::realloc(void *ptr, size_t size)
+{
+    if(!ptr)
+        return alloc(size);
+
+    const ebyte *const bptr = static_cast<const ebyte *>(ptr);
+
+    block_t *block = m_head;
+    while(block && !(bptr >= block->data() && bptr < block->data() + block->size))
+        block = block->prev;
+
+    if(!block)
+        hal_platform.fatalError("EArena::realloc: pointer not owned by arena");
+
+    const size_t offset = size_t(bptr - block->data());
+
+    if(ptr == m_last && block == m_head && offset + size <= block->size)
+    {
+        block->used = offset + emax<size_t>(size, 1);
+        return ptr;
+    }
+
+    const size_t avail = block->used - offset;
+    if(size <= avail)
+        return ptr; // shrinking a buffer which is not on top; nothing to gain
+
+    void *const ret = alloc(size);
+    std::memcpy(ret, ptr, avail);
+    return ret;
+}
+
+//
+// Duplicate a C string into the arena.
+//
+char *EArena::strdup(const char *str)
+{
+    return strndup(str, std::strlen(str));
+}
+
+//
+// Duplicate at most len characters of a string into the arena; the result
+// is always null-terminated.
+//
+char *EArena::strndup(const char *str, size_t len)
+{
+    char *const ret = static_cast<char *>(alloc(len + 1, 1));
+    std::memcpy(ret, str, len);
+    ret[len] = '\0';
+    return ret;
+}
+
+//
+// Remember the current allocation position.
+//
+EArena::mark_t EArena::getMark() const
+{
+    return { m_head, m_head ? m_head->used : 0 };
+}
+
+//
+// Discard everything allocated since the mark was taken. Blocks added since
+// then are returned to the heap, except for one which is kept in reserve so
+// that repeated mark/rewind cycles do not thrash the allocator.
+//
+void EArena::rewind(const mark_t &mark)
+{
+    while(m_head != mark.block)
+    {
+        if(!m_head)
+            hal_platform.fatalError("EArena::rewind: invalid mark");
+
+        block_t *const block = m_head;
+        m_head = block->prev;
+        freeBlock(block);
+    }
+
+    if(m_head)
+        m_head->used = mark.used;
+    m_last = nullptr;
+}
+
+//
+// Free all memory held by the arena. Any pointers into it become invalid.
+//
+void EArena::release()
+{
+    while(m_head)
+    {
+        block_t *const block = m_head;
+        m_head = block->prev;
+        ArenaHeapFree(block);
+    }
+
+    if(m_spare)
+    {
+        ArenaHeapFree(m_spare);
+        m_spare = nullptr;
+    }
+    m_last = nullptr;
+}
+
+//
+// Test if a pointer lies within memory handed out by this arena.
+//
+bool EArena::owns(const void *ptr) const
+{
+    const ebyte *const bptr = static_cast<const ebyte *>(ptr);
+
+    for(const block_t *block = m_head; block; block = block->prev)
+    {
+        if(bptr >= block->data() && bptr < block->data() + block->used)
+            return true;
+    }
+
+    return false;
+}
+
+//
+// Total bytes handed out, including alignment padding.
+//
+size_t EArena::getBytesUsed() const
+{
+    size_t total = 0;
+    for(const block_t *block = m_head; block; block = block->prev)
+        total += block->used;
+    return total;
+}
+
+//
+// Total bytes obtained from the heap for blocks, including the spare.
+//
+size_t EArena::getBytesReserved() const
+{
+    size_t total = m_spare ? m_spare->size : 0;
+    for(const block_t *block = m_head; block; block = block->prev)
+        total += block->size;
+    return total;
+}
+
+//=============================================================================
+//
+// Zone routing
+//
+
+EArenaScope::EArenaScope(EArena &arena) noexcept
+    : m_prev(E_SetCurrentArena(&arena))
+{
+}
+
+EArenaScope::~EArenaScope()
+{
+    E_SetCurrentArena(m_prev);
+}
+
+// EOF
@@ -0,0 +1,134 @@
+/*
+  ELib
+
+  Region allocation
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#if defined(__cplusplus)
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//
+// Bump-pointer region allocator. Memory is carved out of a chain of large
+// blocks obtained through E_Malloc and is never freed individually; it is all
+// returned at once through release(), or back to a previously taken mark via
+// rewind(). This suits data that dies together, such as everything built
+// during a single parse. Objects placed in an arena are never destructed.
+//
+class EArena
+{
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t DEFAULT_ALIGNMENT  = alignof(std::max_align_t);
+
+    struct block_t;
+
+    // Saved allocation position, for use with rewind.
+    struct mark_t
+    {
+        block_t *block;
+        size_t   used;
+    };
+
+    explicit EArena(size_t blockSize = DEFAULT_BLOCK_SIZE) noexcept
+        : m_blockSize(blockSize)
+    {
+    }
+
+    ~EArena() { release(); }
+
+    // non-copyable
+    EArena(const EArena &) = delete;
+    EArena &operator = (const EArena &) = delete;
+
+    void *alloc(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+    void *calloc(size_t count, size_t size);
+    void *realloc(void *ptr, size_t size);
+    char *strdup(const char *str);
+    char *strndup(const char *str, size_t len);
+
+    //
+    // Construct an object inside the arena. Since arena memory is released
+    // in bulk, only trivially destructible types may be placed here.
+    //
+    template<typename T, typename... Args>
+    T *make(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "EArena::make: type must be trivially destructible");
+        return new (alloc(sizeof(T), alignof(T))) T { std::forward<Args>(args)... };
+    }
+
+    mark_t getMark() const;
+    void   rewind(const mark_t &mark);
+    void   release();
+
+    bool   owns(const void *ptr) const;
+    size_t getBytesUsed() const;
+    size_t getBytesReserved() const;
+
+protected:
+    block_t *m_head  = nullptr; // newest block; allocations come from here
+    block_t *m_spare = nullptr; // one retired block kept back by rewind
+    void    *m_last  = nullptr; // most recent allocation, for in-place realloc
+    size_t   m_blockSize;
+
+    block_t *newBlock(size_t minSize);
+    void     freeBlock(block_t *block);
+};
+
+//
+// Routes emalloc, ecalloc, erealloc and estrdup on the calling thread into the
+// given arena for the lifetime of the scope object. efree on arena-owned
+// memory becomes a no-op. Memory allocated while the scope is active must not
+// be freed after the scope ends, and must not outlive the arena.
+//
+class EArenaScope
+{
+public:
+    explicit EArenaScope(EArena &arena) noexcept;
+    ~EArenaScope();
+
+    // non-copyable
+    EArenaScope(const EArenaScope &) = delete;
+    EArenaScope &operator = (const EArenaScope &) = delete;
+
+private:
+    EArena *m_prev;
+};
+
+// Get the arena currently receiving zone allocations on this thread, if any.
+EArena *E_GetCurrentArena();
+
+// Set the arena receiving zone allocations on this thread; returns the previous one.
+EArena *E_SetCurrentArena(EArena *arena);
+
+#endif
+
+// EOF
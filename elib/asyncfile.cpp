@@ -0,0 +1,150 @@
+/*
+  ELib
+
+  Asynchronous whole-file reads and writes
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "elib.h"
+#include "arena.h"
+#include "asyncfile.h"
+#include "qstring.h"
+
+//
+// Requests are freed on the I/O threads, so whatever they hold must come from
+// the heap even if the caller is inside an EArenaScope. This suspends the
+// calling thread's arena for the life of the object.
+//
+class EAsyncHeapScope
+{
+public:
+    EAsyncHeapScope() noexcept : m_prev(E_SetCurrentArena(nullptr)) {}
+    ~EAsyncHeapScope() { E_SetCurrentArena(m_prev); }
+
+    // non-copyable
+    EAsyncHeapScope(const EAsyncHeapScope &) = delete;
+    EAsyncHeapScope &operator = (const EAsyncHeapScope &) = delete;
+
+private:
+    EArena *m_prev;
+};
+
+//
+// A request together with what it needs until its callback.
+//
+template<typename T>
+struct easyncop_t : public EPoolAllocated
+{
+    hal_iorequest_t  req;
+    qstring          path;
+    std::promise<T>  promise;
+
+    easyncop_t(const char *ppath, hal_ioop op, hal_iopriority priority) : req(), path(ppath)
+    {
+        req.op       = op;
+        req.priority = priority;
+        req.path     = path.c_str();
+        req.userdata = this;
+    }
+};
+
+using easyncread_t  = easyncop_t<EAsyncFileData>;
+using easyncwrite_t = easyncop_t<int>;
+
+static void E_AsyncReadDone(hal_iorequest_t *req)
+{
+    easyncread_t *const op = static_cast<easyncread_t *>(req->userdata);
+
+    EAsyncFileData result;
+    result.data.reset(static_cast<ebyte *>(req->buffer));
+    result.size  = req->size;
+    result.error = req->error;
+
+    op->promise.set_value(std::move(result));
+    delete op;
+}
+
+static void E_AsyncWriteDone(hal_iorequest_t *req)
+{
+    easyncwrite_t *const op = static_cast<easyncwrite_t *>(req->userdata);
+
+    efree(req->buffer);
+    op->promise.set_value(req->error);
+    delete op;
+}
+
+//
+// Read a whole file in the background.
+//
+std::future<EAsyncFileData> E_ReadFileAsync(const char *path, hal_iopriority priority)
+{
+    return std::move(E_ReadFilesAsync(&path, 1, priority).front());
+}
+
+//
+// Read several whole files, submitted together as one batch.
+//
+std::vector<std::future<EAsyncFileData>> E_ReadFilesAsync(const char *const *paths, size_t count,
+                                                          hal_iopriority priority)
+{
+    const EAsyncHeapScope heap;
+
+    std::vector<std::future<EAsyncFileData>> futures;
+    std::vector<hal_iorequest_t *>           requests;
+    futures.reserve(count);
+    requests.reserve(count);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        easyncread_t *const op = new easyncread_t(paths[i], HAL_IO_READFILE, priority);
+        op->req.callback = E_AsyncReadDone;
+        futures.push_back(op->promise.get_future());
+        requests.push_back(&op->req);
+    }
+
+    hal_asyncio.submit(requests.data(), requests.size());
+    return futures;
+}
+
+//
+// Replace a file's contents in the background, from a copy of data.
+//
+std::future<int> E_WriteFileAsync(const char *path, const void *data, size_t size, hal_iopriority priority)
+{
+    const EAsyncHeapScope heap;
+
+    easyncwrite_t *const op = new easyncwrite_t(path, HAL_IO_WRITEFILE, priority);
+    op->req.buffer   = emalloc(void, emax<size_t>(size, 1));
+    op->req.size     = size;
+    op->req.callback = E_AsyncWriteDone;
+    if(size)
+        std::memcpy(op->req.buffer, data, size);
+
+    std::future<int> future = op->promise.get_future();
+    hal_iorequest_t *request = &op->req;
+    hal_asyncio.submit(&request, 1);
+    return future;
+}
+
+// EOF
@@ -0,0 +1,66 @@
+/*
+  ELib
+
+  Asynchronous whole-file reads and writes
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <future>
+#include <vector>
+
+#include "elib.h"
+#include "../hal/hal_asyncio.h"
+
+//
+// Contents of a file read through hal_asyncio. The data is followed by a
+// zero byte, so text can be parsed in place.
+//
+struct EAsyncFileData
+{
+    EUniquePtr<ebyte> data;
+    size_t            size  = 0;
+    int               error = 0;  // 0, or an errno value
+};
+
+//
+// Requests may be made inside an EArenaScope: what they allocate always comes
+// from the heap, as it is released on an I/O thread after the scope may have
+// ended.
+//
+
+// Read a whole file in the background.
+std::future<EAsyncFileData> E_ReadFileAsync(const char *path, hal_iopriority priority = HAL_IOPRI_NORMAL);
+
+// Read several whole files, submitted together as one batch.
+std::vector<std::future<EAsyncFileData>> E_ReadFilesAsync(const char *const *paths, size_t count,
+                                                          hal_iopriority priority = HAL_IOPRI_NORMAL);
+
+// Replace a file's contents in the background, from a copy of data. The
+// result is 0 or an errno value.
+std::future<int> E_WriteFileAsync(const char *path, const void *data, size_t size,
+                                  hal_iopriority priority = HAL_IOPRI_NORMAL);
+
+// EOF
@@ -36,7 +36,7 @@ static eatexit_listentry_t *exitFuncs = nullptr;
 //
 void E_AtExit(eatexit_func_t func, int runOnError)
 {
-   auto entry = estructalloc(eatexit_listentry_t, 1);
+   auto entry = static_cast<eatexit_listentry_t *>(E_PoolCalloc(sizeof(eatexit_listentry_t)));
 
    entry->func       = func;
    entry->runOnError = runOnError;
@@ -0,0 +1,121 @@
+/*
+  ELib
+
+  String interning
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <mutex>
+
+#include "elib.h"
+#include "atom.h"
+
+// Atoms are short; keep the arena's blocks modest.
+static constexpr size_t ATOM_BLOCK_SIZE    = 16 * 1024;
+static constexpr size_t ATOM_INITIAL_COUNT = 256;
+
+EAtomTable::EAtomTable(bool ignoreCase)
+    : m_arena(ATOM_BLOCK_SIZE),
+      m_atoms(ATOM_INITIAL_COUNT, atomhash { ignoreCase }, atomequal { ignoreCase })
+{
+}
+
+//
+// Returns the interned copy of str, adding it if it is not yet present.
+//
+const char *EAtomTable::intern(std::string_view str)
+{
+    {
+        std::shared_lock lock(m_lock);
+        if(const char *const *const atom = m_atoms.find(str); atom)
+            return *atom;
+    }
+
+    std::unique_lock lock(m_lock);
+
+    // Another thread may have added it between the locks.
+    if(const char *const *const atom = m_atoms.find(str); atom)
+        return *atom;
+
+    // The table is shared, so its storage must not land in an arena the
+    // calling thread happens to have made current.
+    EArena *const prevArena = E_SetCurrentArena(nullptr);
+
+    const char *const atom = m_arena.strndup(str.data(), str.size());
+    m_atoms.emplace(std::string_view(atom, str.size()), atom);
+
+    E_SetCurrentArena(prevArena);
+    return atom;
+}
+
+//
+// Returns the interned copy of str, or nullptr if it has not been interned.
+//
+const char *EAtomTable::find(std::string_view str) const
+{
+    std::shared_lock lock(m_lock);
+
+    const char *const *const atom = m_atoms.find(str);
+    return atom ? *atom : nullptr;
+}
+
+//
+// Number of distinct strings interned.
+//
+size_t EAtomTable::size() const
+{
+    std::shared_lock lock(m_lock);
+    return m_atoms.size();
+}
+
+//
+// Bytes of string storage used.
+//
+size_t EAtomTable::getBytesUsed() const
+{
+    std::shared_lock lock(m_lock);
+    return m_arena.getBytesUsed();
+}
+
+//
+// The global table is created on first use, so interning is safe from static
+// constructors.
+//
+static EAtomTable &AtomGlobalTable()
+{
+    static EAtomTable table;
+    return table;
+}
+
+const char *E_Intern(std::string_view str)
+{
+    return AtomGlobalTable().intern(str);
+}
+
+const char *E_FindAtom(std::string_view str)
+{
+    return AtomGlobalTable().find(str);
+}
+
+// EOF
@@ -0,0 +1,99 @@
+/*
+  ELib
+
+  String interning
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <shared_mutex>
+#include <string_view>
+
+#include "arena.h"
+#include "ehashmap.h"
+
+//
+// Thread-safe table of interned strings. Each distinct string is copied once
+// into arena storage, and every request for an equal string returns the same
+// pointer, which stays valid for the life of the table. Interned strings can
+// therefore be compared and hashed by address alone.
+//
+// A table created with ignoreCase set treats strings that differ only in
+// ASCII case as equal; the spelling first interned is the one returned.
+//
+class EAtomTable
+{
+public:
+    explicit EAtomTable(bool ignoreCase = false);
+
+    // non-copyable
+    EAtomTable(const EAtomTable &) = delete;
+    EAtomTable &operator = (const EAtomTable &) = delete;
+
+    const char *intern(std::string_view str);
+    const char *find(std::string_view str) const;
+
+    size_t size() const;
+    size_t getBytesUsed() const;
+
+private:
+    struct atomhash
+    {
+        using is_transparent = void;
+        bool ignoreCase;
+
+        size_t operator () (std::string_view sv) const noexcept
+        {
+            return ignoreCase ? qstring::HashCodeStatic(sv) : qstring::HashCodeCaseStatic(sv);
+        }
+    };
+
+    struct atomequal
+    {
+        using is_transparent = void;
+        bool ignoreCase;
+
+        bool operator () (std::string_view a, std::string_view b) const noexcept
+        {
+            return ignoreCase ? qstring::EqualNoCase(a, b) : a == b;
+        }
+    };
+
+    // Keys view the interned copies in m_arena
+    using atommap_t = EHashMap<std::string_view, const char *, atomhash, atomequal>;
+
+    mutable std::shared_mutex m_lock;
+    EArena                    m_arena;
+    atommap_t                 m_atoms;
+};
+
+// Intern a string in the global case-sensitive atom table.
+const char *E_Intern(std::string_view str);
+
+// Look up a string in the global atom table without adding it; returns
+// nullptr if it has never been interned.
+const char *E_FindAtom(std::string_view str);
+
+// EOF
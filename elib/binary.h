@@ -50,6 +50,61 @@
        ((t)((b)[1]) << 16) | \
        ((t)((b)[0]) << 24))
 
+// Read a little-endian qword without alignment assumptions
+#define eread64_le(b, t) \
+   (t)((uint64_t)eread32_le(b, uint32_t) | ((uint64_t)eread32_le((b) + 4, uint32_t) << 32))
+
+// Read a big-endian qword without alignment assumptions
+#define eread64_be(b, t) \
+   (t)((uint64_t)eread32_be((b) + 4, uint32_t) | ((uint64_t)eread32_be(b, uint32_t) << 32))
+
+//
+// Reinterpret the bits of IEEE single and double precision values.
+//
+inline float E_BinaryFloatFromBits(uint32_t bits)
+{
+    float f;
+#if defined(__cplusplus)
+    std::memcpy(&f, &bits, sizeof(f));
+#else
+    memcpy(&f, &bits, sizeof(f));
+#endif
+    return f;
+}
+
+inline uint32_t E_BinaryFloatToBits(float f)
+{
+    uint32_t bits;
+#if defined(__cplusplus)
+    std::memcpy(&bits, &f, sizeof(bits));
+#else
+    memcpy(&bits, &f, sizeof(bits));
+#endif
+    return bits;
+}
+
+inline double E_BinaryDoubleFromBits(uint64_t bits)
+{
+    double d;
+#if defined(__cplusplus)
+    std::memcpy(&d, &bits, sizeof(d));
+#else
+    memcpy(&d, &bits, sizeof(d));
+#endif
+    return d;
+}
+
+inline uint64_t E_BinaryDoubleToBits(double d)
+{
+    uint64_t bits;
+#if defined(__cplusplus)
+    std::memcpy(&bits, &d, sizeof(bits));
+#else
+    memcpy(&bits, &d, sizeof(bits));
+#endif
+    return bits;
+}
+
 //
 // Read an int16 from the lump data, but do not increment the read pointer.
 //
@@ -194,6 +249,108 @@ inline uint32_t E_GetBinaryUDWordBE(const ebyte **data)
    return val;
 }
 
+//
+// Read a uint64 from the lump data, but do not increment the read pointer.
+//
+inline uint64_t E_ReadBinaryUQWord(const ebyte *data)
+{
+   return eread64_le(data, uint64_t);
+}
+
+//
+// Read a uint64, big-endian, from the lump data, but do not increment the read pointer.
+//
+inline uint64_t E_ReadBinaryUQWordBE(const ebyte *data)
+{
+   return eread64_be(data, uint64_t);
+}
+
+//
+// Reads a uint64 from the lump data and increments the read pointer.
+//
+inline uint64_t E_GetBinaryUQWord(const ebyte **data)
+{
+   const uint64_t val = eread64_le(*data, uint64_t);
+   *data += 8;
+
+   return val;
+}
+
+//
+// Reads a uint64, big-endian, from the lump data and increments the read pointer.
+//
+inline uint64_t E_GetBinaryUQWordBE(const ebyte **data)
+{
+   const uint64_t val = eread64_be(*data, uint64_t);
+   *data += 8;
+
+   return val;
+}
+
+//
+// Reads an int64 from the lump data and increments the read pointer.
+//
+inline int64_t E_GetBinaryQWord(const ebyte **data)
+{
+   return (int64_t)E_GetBinaryUQWord(data);
+}
+
+//
+// Reads an int64, big-endian, from the lump data and increments the read pointer.
+//
+inline int64_t E_GetBinaryQWordBE(const ebyte **data)
+{
+   return (int64_t)E_GetBinaryUQWordBE(data);
+}
+
+//
+// Read a float from the lump data, but do not increment the read pointer.
+//
+inline float E_ReadBinaryFloat(const ebyte *data)
+{
+   return E_BinaryFloatFromBits(eread32_le(data, uint32_t));
+}
+
+//
+// Reads a float from the lump data and increments the read pointer.
+//
+inline float E_GetBinaryFloat(const ebyte **data)
+{
+   return E_BinaryFloatFromBits(E_GetBinaryUDWord(data));
+}
+
+//
+// Reads a float, big-endian, from the lump data and increments the read pointer.
+//
+inline float E_GetBinaryFloatBE(const ebyte **data)
+{
+   return E_BinaryFloatFromBits(E_GetBinaryUDWordBE(data));
+}
+
+//
+// Read a double from the lump data, but do not increment the read pointer.
+//
+inline double E_ReadBinaryDouble(const ebyte *data)
+{
+   return E_BinaryDoubleFromBits(eread64_le(data, uint64_t));
+}
+
+//
+// Reads a double from the lump data and increments the read pointer.
+//
+inline double E_GetBinaryDouble(const ebyte **data)
+{
+   return E_BinaryDoubleFromBits(E_GetBinaryUQWord(data));
+}
+
+//
+// Reads a double, big-endian, from the lump data and increments the read pointer.
+//
+inline double E_GetBinaryDoubleBE(const ebyte **data)
+{
+   return E_BinaryDoubleFromBits(E_GetBinaryUQWordBE(data));
+}
+
 //
 // Reads a "len"-byte string from the lump data and writes it into the 
 // destination buffer. The read pointer is incremented by len bytes.
@@ -291,6 +448,113 @@ inline void E_PutBinaryDWord(ebyte **data, int32_t val)
     *data += 4;
 }
 
+//
+// Write a binary unsigned qword without advancing the write pointer
+//
+inline void E_WriteBinaryUQWord(ebyte *data, uint64_t val)
+{
+    E_WriteBinaryUDWord(data,     (uint32_t)val);
+    E_WriteBinaryUDWord(data + 4, (uint32_t)(val >> 32));
+}
+
+//
+// Write a binary unsigned qword, big-endian, without advancing the write pointer
+//
+inline void E_WriteBinaryUQWordBE(ebyte *data, uint64_t val)
+{
+    for(int i = 7; i >= 0; i--, val >>= 8)
+        data[i] = (ebyte)(val & 0xff);
+}
+
+//
+// Write a binary unsigned qword, advancing the write pointer
+//
+inline void E_PutBinaryUQWord(ebyte **data, uint64_t val)
+{
+    E_WriteBinaryUQWord(*data, val);
+    *data += 8;
+}
+
+//
+// Write a binary unsigned qword, big-endian, advancing the write pointer
+//
+inline void E_PutBinaryUQWordBE(ebyte **data, uint64_t val)
+{
+    E_WriteBinaryUQWordBE(*data, val);
+    *data += 8;
+}
+
+//
+// Write a binary signed qword, advancing the write pointer
+//
+inline void E_PutBinaryQWord(ebyte **data, int64_t val)
+{
+    E_PutBinaryUQWord(data, (uint64_t)val);
+}
+
+//
+// Write a binary signed qword, big-endian, advancing the write pointer
+//
+inline void E_PutBinaryQWordBE(ebyte **data, int64_t val)
+{
+    E_PutBinaryUQWordBE(data, (uint64_t)val);
+}
+
+//
+// Write a binary float without advancing the write pointer
+//
+inline void E_WriteBinaryFloat(ebyte *data, float val)
+{
+    E_WriteBinaryUDWord(data, E_BinaryFloatToBits(val));
+}
+
+//
+// Write a binary float, advancing the write pointer
+//
+inline void E_PutBinaryFloat(ebyte **data, float val)
+{
+    E_PutBinaryUDWord(data, E_BinaryFloatToBits(val));
+}
+
+//
+// Write a binary float, big-endian, advancing the write pointer
+//
+inline void E_PutBinaryFloatBE(ebyte **data, float val)
+{
+    const uint32_t bits = E_BinaryFloatToBits(val);
+    ebyte *const   p    = *data;
+
+    p[0] = (ebyte)(bits >> 24);
+    p[1] = (ebyte)(bits >> 16);
+    p[2] = (ebyte)(bits >>  8);
+    p[3] = (ebyte)bits;
+    *data += 4;
+}
+
+//
+// Write a binary double without advancing the write pointer
+//
+inline void E_WriteBinaryDouble(ebyte *data, double val)
+{
+    E_WriteBinaryUQWord(data, E_BinaryDoubleToBits(val));
+}
+
+//
+// Write a binary double, advancing the write pointer
+//
+inline void E_PutBinaryDouble(ebyte **data, double val)
+{
+    E_PutBinaryUQWord(data, E_BinaryDoubleToBits(val));
+}
+
+//
+// Write a binary double, big-endian, advancing the write pointer
+//
+inline void E_PutBinaryDoubleBE(ebyte **data, double val)
+{
+    E_PutBinaryUQWordBE(data, E_BinaryDoubleToBits(val));
+}
+
 //
 // Writes a "len"-byte string to output data without incrementing the output pointer.
 //
@@ -312,4 +576,136 @@ inline void E_PutBinaryString(ebyte **dest, const char *src, size_t len)
     *dest += len;
 }
 
+// ============================================================================
+//
+// Variable-length integers
+//
+// Unsigned values are stored as LEB128: seven bits per byte, least
+// significant group first, with the high bit set on every byte but the last.
+// Signed values are zigzag-mapped first (0, -1, 1, -2, ... to 0, 1, 2, 3,
+// ...) so that small magnitudes of either sign stay short. A 64-bit value
+// takes at most E_VARINT_MAXSIZE bytes.
+//
+// ============================================================================
+
+#define E_VARINT_MAXSIZE 10
+
+inline uint64_t E_ZigZagEncode(int64_t val)
+{
+    return ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+}
+
+inline int64_t E_ZigZagDecode(uint64_t val)
+{
+    return (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+}
+
+//
+// Number of bytes val takes as a varint.
+//
+inline size_t E_VarUIntSize(uint64_t val)
+{
+    size_t size = 1;
+    while(val >= 0x80)
+    {
+        val >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+//
+// Write an unsigned varint, which needs up to E_VARINT_MAXSIZE bytes, and
+// return the number of bytes written.
+//
+inline size_t E_WriteVarUInt(ebyte *data, uint64_t val)
+{
+    size_t i = 0;
+    while(val >= 0x80)
+    {
+        data[i++] = (ebyte)(val | 0x80);
+        val >>= 7;
+    }
+    data[i++] = (ebyte)val;
+    return i;
+}
+
+//
+// Write an unsigned varint, advancing the write pointer
+//
+inline void E_PutVarUInt(ebyte **data, uint64_t val)
+{
+    *data += E_WriteVarUInt(*data, val);
+}
+
+//
+// Write a signed varint, advancing the write pointer
+//
+inline void E_PutVarInt(ebyte **data, int64_t val)
+{
+    *data += E_WriteVarUInt(*data, E_ZigZagEncode(val));
+}
+
+//
+// Read an unsigned varint from at most size bytes. Returns the number of
+// bytes it took, or 0 if it is cut off or too long for 64 bits.
+//
+inline size_t E_ReadVarUInt(const ebyte *data, size_t size, uint64_t *val)
+{
+    if(size >= 2)
+    {
+        // One or two bytes cover values below 16384, and are decoded without
+        // branching on which: the second byte counts only if the first has
+        // its high bit set.
+        const unsigned int b0 = data[0];
+        const unsigned int b1 = data[1];
+        if((b0 & b1 & 0x80) == 0)
+        {
+            const unsigned int more = b0 >> 7;
+            *val = (b0 & 0x7f) | ((b1 << 7) & (0u - more) & 0x3f80);
+            return 1 + more;
+        }
+    }
+
+    uint64_t result = 0;
+    size_t   i;
+    for(i = 0; i < size && i < E_VARINT_MAXSIZE; i++)
+    {
+        const ebyte b = data[i];
+        result |= (uint64_t)(b & 0x7f) << (7 * i);
+        if(!(b & 0x80))
+        {
+            if(i == E_VARINT_MAXSIZE - 1 && b > 1)
+                return 0; // more than 64 bits
+            *val = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+//
+// Reads an unsigned varint ending by end and advances the read pointer.
+// Returns 0, leaving the pointer alone, if there is no valid varint there.
+//
+inline int E_GetVarUInt(const ebyte **data, const ebyte *end, uint64_t *val)
+{
+    const size_t len = E_ReadVarUInt(*data, (size_t)(end - *data), val);
+    *data += len;
+    return len != 0;
+}
+
+//
+// Reads a signed varint ending by end and advances the read pointer.
+// Returns 0, leaving the pointer alone, if there is no valid varint there.
+//
+inline int E_GetVarInt(const ebyte **data, const ebyte *end, int64_t *val)
+{
+    uint64_t bits;
+    if(!E_GetVarUInt(data, end, &bits))
+        return 0;
+    *val = E_ZigZagDecode(bits);
+    return 1;
+}
+
 // EOF
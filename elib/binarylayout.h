@@ -0,0 +1,442 @@
+/*
+  ELib
+
+  Declarative binary record layouts
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "elib.h"
+#include "swap.h"
+
+//
+// A binary record format is described once, as a list of fields:
+//
+//    struct filelump_t { int32_t filepos; int32_t size; char name[8]; };
+//    using filelump_layout = EBinaryLayout<EBinField<&filelump_t::filepos>,
+//                                          EBinField<&filelump_t::size>,
+//                                          EBinField<&filelump_t::name>>;
+//
+// and the layout then decodes and encodes whole records, with one length
+// check per record, or per array of records. The field accesses are
+// expanded inline at fixed offsets.
+//
+
+enum ebyteorder_e
+{
+    EBO_LITTLE,
+    EBO_BIG
+};
+
+//
+// Encoding of one value of type T: integers, enumerations, and floats of the
+// same width as their bytes, and arrays as their elements in sequence.
+//
+template<typename T, ebyteorder_e order>
+struct EBinCodec
+{
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "EBinCodec: unsupported type");
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8,
+                  "EBinCodec: unsupported size");
+
+    static constexpr size_t Size = sizeof(T);
+
+#if defined(ELIB_BIG_ENDIAN)
+    static constexpr bool Swap = (Size > 1 && order == EBO_LITTLE);
+#else
+    static constexpr bool Swap = (Size > 1 && order == EBO_BIG);
+#endif
+
+    using bits_t = std::conditional_t<Size == 1, uint8_t,
+                   std::conditional_t<Size == 2, uint16_t,
+                   std::conditional_t<Size == 4, uint32_t, uint64_t>>>;
+
+    static bits_t SwapBits(bits_t bits)
+    {
+        if constexpr(!Swap)
+            return bits;
+        else if constexpr(Size == 2)
+            return E_ByteSwap16(bits);
+        else if constexpr(Size == 4)
+            return E_ByteSwap32(bits);
+        else
+            return E_ByteSwap64(bits);
+    }
+
+    static void Decode(const ebyte *data, T &value)
+    {
+        bits_t bits;
+        std::memcpy(&bits, data, Size);
+        bits = SwapBits(bits);
+        std::memcpy(&value, &bits, Size);
+    }
+
+    static void Encode(ebyte *data, const T &value)
+    {
+        bits_t bits;
+        std::memcpy(&bits, &value, Size);
+        bits = SwapBits(bits);
+        std::memcpy(data, &bits, Size);
+    }
+};
+
+template<typename T, size_t N, ebyteorder_e order>
+struct EBinCodec<T[N], order>
+{
+    using element_t = EBinCodec<T, order>;
+
+    static constexpr size_t Size = N * element_t::Size;
+
+    static void Decode(const ebyte *data, T (&value)[N])
+    {
+        if constexpr(!element_t::Swap)
+            std::memcpy(value, data, Size);
+        else
+        {
+            for(size_t i = 0; i < N; i++)
+                element_t::Decode(data + i * element_t::Size, value[i]);
+        }
+    }
+
+    static void Encode(ebyte *data, const T (&value)[N])
+    {
+        if constexpr(!element_t::Swap)
+            std::memcpy(data, value, Size);
+        else
+        {
+            for(size_t i = 0; i < N; i++)
+                element_t::Encode(data + i * element_t::Size, value[i]);
+        }
+    }
+};
+
+template<typename M>
+struct EBinMemberTraits;
+
+template<typename R, typename T>
+struct EBinMemberTraits<T R::*>
+{
+    using record_t = R;
+    using value_t  = T;
+};
+
+//
+// A field stored from the record member at member, in the given byte order.
+// Scalar members may be stored as a different type, e.g. an int kept as an
+// int16_t on disk; they are converted with static_cast both ways.
+//
+template<auto member, ebyteorder_e order = EBO_LITTLE, typename stored = void>
+struct EBinField
+{
+    using record_t = typename EBinMemberTraits<decltype(member)>::record_t;
+    using value_t  = typename EBinMemberTraits<decltype(member)>::value_t;
+    using stored_t = std::conditional_t<std::is_void_v<stored>, value_t, stored>;
+    using codec_t  = EBinCodec<stored_t, order>;
+
+    static_assert(std::is_same_v<stored_t, value_t> || std::is_arithmetic_v<value_t> ||
+                  std::is_enum_v<value_t>, "EBinField: only scalars may change type");
+
+    static constexpr size_t Size      = codec_t::Size;
+    static constexpr bool   IsPadding = false;
+
+    static void DecodeValue(const ebyte *data, value_t &value)
+    {
+        if constexpr(std::is_same_v<stored_t, value_t>)
+            codec_t::Decode(data, value);
+        else
+        {
+            stored_t tmp;
+            codec_t::Decode(data, tmp);
+            value = static_cast<value_t>(tmp);
+        }
+    }
+
+    static void EncodeValue(ebyte *data, const value_t &value)
+    {
+        if constexpr(std::is_same_v<stored_t, value_t>)
+            codec_t::Encode(data, value);
+        else
+            codec_t::Encode(data, static_cast<stored_t>(value));
+    }
+
+    static void Decode(const ebyte *data, record_t &record) { DecodeValue(data, record.*member); }
+    static void Encode(ebyte *data, const record_t &record) { EncodeValue(data, record.*member); }
+};
+
+template<auto member, typename stored = void>
+using EBinFieldBE = EBinField<member, EBO_BIG, stored>;
+
+//
+// Bytes of the format not kept in the record. They are skipped when read
+// and zeroed when written.
+//
+template<size_t N>
+struct EBinPad
+{
+    using record_t = void;
+
+    static constexpr size_t Size      = N;
+    static constexpr bool   IsPadding = true;
+
+    template<typename R>
+    static void Decode(const ebyte *, R &) {}
+
+    template<typename R>
+    static void Encode(ebyte *data, const R &) { std::memset(data, 0, N); }
+};
+
+//
+// Record type of the first field that has one.
+//
+template<typename... Fields>
+struct EBinRecordOf;
+
+template<typename F, typename... Fields>
+struct EBinRecordOf<F, Fields...>
+{
+    using type = std::conditional_t<F::IsPadding, typename EBinRecordOf<Fields...>::type,
+                                    typename F::record_t>;
+};
+
+template<>
+struct EBinRecordOf<>
+{
+    using type = void;
+};
+
+template<typename... Fields>
+class EBinaryLayout
+{
+public:
+    using record_t = typename EBinRecordOf<Fields...>::type;
+
+    static_assert(!std::is_void_v<record_t>, "EBinaryLayout: no fields");
+    static_assert(((Fields::IsPadding || std::is_same_v<typename Fields::record_t, record_t>) && ...),
+                  "EBinaryLayout: fields of different records");
+
+    static constexpr size_t NumFields = sizeof...(Fields);
+    static constexpr size_t NumValues = ((Fields::IsPadding ? 0 : 1) + ...);
+    static constexpr size_t Size      = (Fields::Size + ...);
+
+protected:
+    using fields_t = std::tuple<Fields...>;
+
+    template<size_t I>
+    using field_t = std::tuple_element_t<I, fields_t>;
+
+    static constexpr std::array<size_t, NumFields> Offsets = []
+    {
+        constexpr size_t sizes[] = { Fields::Size... };
+        std::array<size_t, NumFields> offsets {};
+        size_t at = 0;
+        for(size_t i = 0; i < NumFields; i++)
+        {
+            offsets[i] = at;
+            at += sizes[i];
+        }
+        return offsets;
+    }();
+
+    // indices of the fields that are not padding
+    static constexpr std::array<size_t, NumValues> Values = []
+    {
+        constexpr bool padding[] = { Fields::IsPadding... };
+        std::array<size_t, NumValues> values {};
+        size_t n = 0;
+        for(size_t i = 0; i < NumFields; i++)
+        {
+            if(!padding[i])
+                values[n++] = i;
+        }
+        return values;
+    }();
+
+    template<size_t... I>
+    static void DecodeFields(const ebyte *data, record_t &record, std::index_sequence<I...>)
+    {
+        (field_t<I>::Decode(data + Offsets[I], record), ...);
+    }
+
+    template<size_t... I>
+    static void EncodeFields(ebyte *data, const record_t &record, std::index_sequence<I...>)
+    {
+        (field_t<I>::Encode(data + Offsets[I], record), ...);
+    }
+
+    template<size_t... J, typename... Columns>
+    static void DecodeColumns(const ebyte *data, size_t index, std::index_sequence<J...>,
+                              Columns *...columns)
+    {
+        (field_t<Values[J]>::DecodeValue(data + Offsets[Values[J]], columns[index]), ...);
+    }
+
+    template<size_t... J, typename... Columns>
+    static void EncodeColumns(ebyte *data, size_t index, std::index_sequence<J...>,
+                              const Columns *...columns)
+    {
+        (field_t<Values[J]>::EncodeValue(data + Offsets[Values[J]], columns[index]), ...);
+    }
+
+    template<typename... Columns, size_t... J>
+    static constexpr bool ColumnsMatch(std::index_sequence<J...>)
+    {
+        return (std::is_same_v<Columns, typename field_t<Values[J]>::value_t> && ...);
+    }
+
+public:
+    //
+    // Decode one record from data, without checking its length.
+    //
+    static void Decode(const ebyte *data, record_t &record)
+    {
+        DecodeFields(data, record, std::index_sequence_for<Fields...>());
+    }
+
+    //
+    // Encode one record to data, without checking its length.
+    //
+    static void Encode(ebyte *data, const record_t &record)
+    {
+        EncodeFields(data, record, std::index_sequence_for<Fields...>());
+    }
+
+    //
+    // Decode one record, if size bytes hold one.
+    //
+    static bool Read(const ebyte *data, size_t size, record_t &record)
+    {
+        if(size < Size)
+            return false;
+        Decode(data, record);
+        return true;
+    }
+
+    //
+    // Encode one record, if size bytes have room for it.
+    //
+    static bool Write(ebyte *data, size_t size, const record_t &record)
+    {
+        if(size < Size)
+            return false;
+        Encode(data, record);
+        return true;
+    }
+
+    //
+    // Decode a record at the read pointer and advance it, if the record ends
+    // by end. Otherwise the pointer is left alone.
+    //
+    static bool Get(const ebyte **data, const ebyte *end, record_t &record)
+    {
+        if(!Read(*data, size_t(end - *data), record))
+            return false;
+        *data += Size;
+        return true;
+    }
+
+    //
+    // Encode a record at the write pointer and advance it, if it fits by end.
+    //
+    static bool Put(ebyte **data, const ebyte *end, const record_t &record)
+    {
+        if(!Write(*data, size_t(end - *data), record))
+            return false;
+        *data += Size;
+        return true;
+    }
+
+    //
+    // Decode up to count records into an array, as many as size bytes hold.
+    // Returns the number decoded.
+    //
+    static size_t ReadArray(const ebyte *data, size_t size, record_t *records, size_t count)
+    {
+        const size_t n = emin(count, size / Size);
+        for(size_t i = 0; i < n; i++)
+            Decode(data + i * Size, records[i]);
+        return n;
+    }
+
+    //
+    // Encode up to count records from an array, as many as fit in size bytes.
+    // Returns the number encoded.
+    //
+    static size_t WriteArray(ebyte *data, size_t size, const record_t *records, size_t count)
+    {
+        const size_t n = emin(count, size / Size);
+        for(size_t i = 0; i < n; i++)
+            Encode(data + i * Size, records[i]);
+        return n;
+    }
+
+    //
+    // Decode up to count records into one array per field, given in field
+    // order with padding left out, each of the member's type:
+    //    layout::ReadColumns(data, size, n, filepos, sizes, names);
+    // Returns the number decoded.
+    //
+    template<typename... Columns>
+    static size_t ReadColumns(const ebyte *data, size_t size, size_t count, Columns *...columns)
+    {
+        static_assert(sizeof...(Columns) == NumValues, "EBinaryLayout: one column per field");
+        static_assert(ColumnsMatch<Columns...>(std::make_index_sequence<NumValues>()),
+                      "EBinaryLayout: column types differ from their fields");
+
+        const size_t n = emin(count, size / Size);
+        for(size_t i = 0; i < n; i++)
+            DecodeColumns(data + i * Size, i, std::make_index_sequence<NumValues>(), columns...);
+        return n;
+    }
+
+    //
+    // Encode up to count records from one array per field, as for ReadColumns.
+    // Returns the number encoded.
+    //
+    template<typename... Columns>
+    static size_t WriteColumns(ebyte *data, size_t size, size_t count, const Columns *...columns)
+    {
+        static_assert(sizeof...(Columns) == NumValues, "EBinaryLayout: one column per field");
+        static_assert(ColumnsMatch<Columns...>(std::make_index_sequence<NumValues>()),
+                      "EBinaryLayout: column types differ from their fields");
+
+        const size_t n = emin(count, size / Size);
+        for(size_t i = 0; i < n; i++)
+        {
+            ebyte *const record = data + i * Size;
+            if constexpr(NumValues < NumFields)
+                std::memset(record, 0, Size); // padding
+            EncodeColumns(record, i, std::make_index_sequence<NumValues>(), columns...);
+        }
+        return n;
+    }
+};
+
+// EOF
@@ -0,0 +1,66 @@
+/*
+  ELib
+
+  Bounds-checked byte stream cursors
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "elib.h"
+#include "../hal/hal_platform.h"
+#include "bytestream.h"
+
+//
+// Make room for at least n more bytes, at least doubling the capacity so that
+// a long run of small writes costs amortized constant time.
+//
+void EByteWriter::grow(size_t n)
+{
+    constexpr size_t MIN_CAPACITY = 64;
+
+    if(n > SIZE_MAX - m_size)
+        hal_platform.fatalError("EByteWriter::grow: overflow on growth by %zu bytes", n);
+
+    const size_t needed   = m_size + n;
+    size_t       capacity = emax(m_capacity, MIN_CAPACITY);
+    while(capacity < needed)
+        capacity = (capacity > SIZE_MAX / 2) ? needed : capacity * 2;
+
+    m_buffer   = erealloc(ebyte, m_buffer, capacity);
+    m_capacity = capacity;
+}
+
+//
+// Make room for count elements of the given size, returning their total size.
+//
+size_t EByteWriter::requireArray(size_t count, size_t size)
+{
+    if(size && count > SIZE_MAX / size)
+        hal_platform.fatalError("EByteWriter::requireArray: overflow on write of %zu elements", count);
+
+    const size_t n = count * size;
+    require(n);
+    return n;
+}
+
+// EOF
@@ -0,0 +1,379 @@
+/*
+  ELib
+
+  Bounds-checked byte stream cursors
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <string_view>
+#include <utility>
+
+#include "elib.h"
+#include "binary.h"
+#include "swap.h"
+
+//
+// Reads binary data through a cursor that knows where the data ends.
+//
+// Range checks are made per batch: require(n) checks that n more bytes
+// remain, and the fixed-size get methods after it read without checking.
+//
+//    if(!reader.require(12))
+//       return false;
+//    x = reader.getDWord();
+//    y = reader.getDWord();
+//    z = reader.getDWord();
+//
+// Methods reading a variable or caller-given amount check for themselves.
+// A failed check is remembered and fails every later one, so a series of
+// such reads can be tested once at the end through failed().
+// In debug builds, the unchecked methods assert that they stay in range.
+//
+class EByteReader
+{
+public:
+    EByteReader() = default;
+    EByteReader(const void *data, size_t size)
+        : m_begin(static_cast<const ebyte *>(data)), m_cursor(m_begin), m_end(m_begin + size)
+    {
+    }
+
+    //
+    // Check that n more bytes can be read, and that no check has failed yet.
+    // On failure the reader is marked failed and the cursor does not move.
+    //
+    bool require(size_t n)
+    {
+        return (!m_failed && n <= remaining()) || fail();
+    }
+
+    const ebyte *getData()   const { return m_begin; }
+    const ebyte *getCursor() const { return m_cursor; }
+    size_t       size()      const { return size_t(m_end - m_begin); }
+    size_t       tell()      const { return size_t(m_cursor - m_begin); }
+    size_t       remaining() const { return size_t(m_end - m_cursor); }
+    bool         atEnd()     const { return m_cursor == m_end; }
+    bool         failed()    const { return m_failed; }
+
+    bool seek(size_t pos)
+    {
+        if(pos > size())
+            return fail();
+        m_cursor = m_begin + pos;
+        return true;
+    }
+
+    bool skip(size_t n)
+    {
+        if(!require(n))
+            return false;
+        m_cursor += n;
+        return true;
+    }
+
+    // Fixed-size reads; require() them first.
+    ebyte    getByte()       { return *take(1); }
+    int16_t  getWord()       { return E_ReadBinaryWord(take(2)); }
+    uint16_t getUWord()      { return E_ReadBinaryUWord(take(2)); }
+    uint16_t getUWordBE()    { return E_ReadBinaryUWordBE(take(2)); }
+    int32_t  getDWord()      { return E_ReadBinaryDWord(take(4)); }
+    int32_t  getDWordBE()    { return E_ReadBinaryDWordBE(take(4)); }
+    uint32_t getUDWord()     { return E_ReadBinaryUDWord(take(4)); }
+    uint32_t getUDWordBE()   { return E_ReadBinaryUDWordBE(take(4)); }
+    int64_t  getQWord()      { return int64_t(E_ReadBinaryUQWord(take(8))); }
+    int64_t  getQWordBE()    { return int64_t(E_ReadBinaryUQWordBE(take(8))); }
+    uint64_t getUQWord()     { return E_ReadBinaryUQWord(take(8)); }
+    uint64_t getUQWordBE()   { return E_ReadBinaryUQWordBE(take(8)); }
+    float    getFloat()      { return E_ReadBinaryFloat(take(4)); }
+    float    getFloatBE()    { return E_BinaryFloatFromBits(E_ReadBinaryUDWordBE(take(4))); }
+    double   getDouble()     { return E_ReadBinaryDouble(take(8)); }
+    double   getDoubleBE()   { return E_BinaryDoubleFromBits(E_ReadBinaryUQWordBE(take(8))); }
+
+    //
+    // Get a pointer to the next n bytes and move past them, or nullptr if
+    // there are not that many.
+    //
+    const ebyte *getBytes(size_t n) { return require(n) ? take(n) : nullptr; }
+
+    std::string_view getView(size_t n)
+    {
+        const ebyte *const bytes = getBytes(n);
+        return bytes ? std::string_view(reinterpret_cast<const char *>(bytes), n) : std::string_view();
+    }
+
+    bool getBytes(void *dest, size_t n)
+    {
+        const ebyte *const bytes = getBytes(n);
+        if(bytes)
+            std::memcpy(dest, bytes, n);
+        return bytes != nullptr;
+    }
+
+    bool getVarUInt(uint64_t &val)
+    {
+        if(m_failed || !E_GetVarUInt(&m_cursor, m_end, &val))
+            return fail();
+        return true;
+    }
+
+    bool getVarInt(int64_t &val)
+    {
+        if(m_failed || !E_GetVarInt(&m_cursor, m_end, &val))
+            return fail();
+        return true;
+    }
+
+    //
+    // Read count values in a byte order into host order.
+    //
+    bool getUWordArray(uint16_t *dest, size_t count)     { return getArray(dest, count, E_ReadLE16Array); }
+    bool getUWordArrayBE(uint16_t *dest, size_t count)   { return getArray(dest, count, E_ReadBE16Array); }
+    bool getUDWordArray(uint32_t *dest, size_t count)    { return getArray(dest, count, E_ReadLE32Array); }
+    bool getUDWordArrayBE(uint32_t *dest, size_t count)  { return getArray(dest, count, E_ReadBE32Array); }
+    bool getUQWordArray(uint64_t *dest, size_t count)    { return getArray(dest, count, E_ReadLE64Array); }
+    bool getUQWordArrayBE(uint64_t *dest, size_t count)  { return getArray(dest, count, E_ReadBE64Array); }
+
+    //
+    // Read records described by an EBinaryLayout from binarylayout.h.
+    //
+    template<typename L>
+    bool getRecord(typename L::record_t &record)
+    {
+        if(!require(L::Size))
+            return false;
+        L::Decode(take(L::Size), record);
+        return true;
+    }
+
+    template<typename L>
+    bool getRecords(typename L::record_t *records, size_t count)
+    {
+        if(m_failed || count > remaining() / L::Size)
+            return fail();
+        m_cursor += L::ReadArray(m_cursor, remaining(), records, count) * L::Size;
+        return true;
+    }
+
+private:
+    const ebyte *m_begin  = nullptr;
+    const ebyte *m_cursor = nullptr;
+    const ebyte *m_end    = nullptr;
+    bool         m_failed = false;
+
+    bool fail()
+    {
+        m_failed = true;
+        return false;
+    }
+
+    const ebyte *take(size_t n)
+    {
+        eassert(n <= remaining());
+        const ebyte *const at = m_cursor;
+        m_cursor += n;
+        return at;
+    }
+
+    template<typename T>
+    bool getArray(T *dest, size_t count, void (*convert)(void *, const void *, size_t))
+    {
+        if(m_failed || count > remaining() / sizeof(T))
+            return fail();
+        convert(dest, take(count * sizeof(T)), count);
+        return true;
+    }
+};
+
+//
+// Writes binary data into a buffer it owns, which grows geometrically as
+// needed. Allocation goes through erealloc, so a writer used inside an
+// EArenaScope builds its output in that arena. Such a writer must then be
+// destroyed, and any buffer taken from release() freed, before the scope
+// ends; otherwise efree would hand arena memory to the heap.
+//
+// As with EByteReader, require(n) makes room for n more bytes, which the
+// fixed-size put methods then write without checking. Methods writing a
+// variable or caller-given amount make room for themselves.
+//
+class EByteWriter
+{
+public:
+    EByteWriter() = default;
+    explicit EByteWriter(size_t capacity) { require(capacity); }
+    ~EByteWriter() { if(m_buffer) efree(m_buffer); }
+
+    EByteWriter(EByteWriter &&other) noexcept
+        : m_buffer(std::exchange(other.m_buffer, nullptr)),
+          m_size(std::exchange(other.m_size, 0)),
+          m_capacity(std::exchange(other.m_capacity, 0))
+    {
+    }
+
+    EByteWriter &operator = (EByteWriter &&other) noexcept
+    {
+        std::swap(m_buffer,   other.m_buffer);
+        std::swap(m_size,     other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+        return *this;
+    }
+
+    // non-copyable
+    EByteWriter(const EByteWriter &) = delete;
+    EByteWriter &operator = (const EByteWriter &) = delete;
+
+    //
+    // Make room for n more bytes.
+    //
+    void require(size_t n)
+    {
+        if(n > m_capacity - m_size)
+            grow(n);
+    }
+
+    ebyte       *getData()       { return m_buffer; }
+    const ebyte *getData() const { return m_buffer; }
+    size_t       getSize() const { return m_size; }
+    size_t       capacity() const { return m_capacity; }
+
+    void clear() { m_size = 0; }
+
+    //
+    // Hand over the buffer, which must be freed with efree, and start over.
+    //
+    ebyte *release()
+    {
+        m_size = m_capacity = 0;
+        return std::exchange(m_buffer, nullptr);
+    }
+
+    // Fixed-size writes; require() them first.
+    void putByte(ebyte val)          { *take(1) = val; }
+    void putWord(int16_t val)        { E_WriteBinaryWord(take(2), val); }
+    void putUWord(uint16_t val)      { E_WriteBinaryUWord(take(2), val); }
+    void putDWord(int32_t val)       { E_WriteBinaryDWord(take(4), val); }
+    void putUDWord(uint32_t val)     { E_WriteBinaryUDWord(take(4), val); }
+    void putQWord(int64_t val)       { E_WriteBinaryUQWord(take(8), uint64_t(val)); }
+    void putUQWord(uint64_t val)     { E_WriteBinaryUQWord(take(8), val); }
+    void putUQWordBE(uint64_t val)   { E_WriteBinaryUQWordBE(take(8), val); }
+    void putFloat(float val)         { E_WriteBinaryFloat(take(4), val); }
+    void putDouble(double val)       { E_WriteBinaryDouble(take(8), val); }
+    void putDoubleBE(double val)     { E_WriteBinaryUQWordBE(take(8), E_BinaryDoubleToBits(val)); }
+
+    void putUWordBE(uint16_t val)
+    {
+        ebyte *const p = take(2);
+        p[0] = ebyte(val >> 8);
+        p[1] = ebyte(val);
+    }
+
+    void putUDWordBE(uint32_t val)
+    {
+        ebyte *const p = take(4);
+        p[0] = ebyte(val >> 24);
+        p[1] = ebyte(val >> 16);
+        p[2] = ebyte(val >>  8);
+        p[3] = ebyte(val);
+    }
+
+    void putDWordBE(int32_t val) { putUDWordBE(uint32_t(val)); }
+    void putFloatBE(float val)   { putUDWordBE(E_BinaryFloatToBits(val)); }
+
+    void putBytes(const void *src, size_t n)
+    {
+        require(n);
+        if(n)
+            std::memcpy(take(n), src, n);
+    }
+
+    //
+    // Append n bytes to be filled in by the caller, returning where they are.
+    // The pointer is good until the next write.
+    //
+    ebyte *putSpace(size_t n)
+    {
+        require(n);
+        return take(n);
+    }
+
+    void putVarUInt(uint64_t val)
+    {
+        require(E_VARINT_MAXSIZE);
+        m_size += E_WriteVarUInt(m_buffer + m_size, val);
+    }
+
+    void putVarInt(int64_t val) { putVarUInt(E_ZigZagEncode(val)); }
+
+    //
+    // Write count host-order values in a byte order.
+    //
+    void putUWordArray(const uint16_t *src, size_t count)     { putArray(src, count, E_WriteLE16Array); }
+    void putUWordArrayBE(const uint16_t *src, size_t count)   { putArray(src, count, E_WriteBE16Array); }
+    void putUDWordArray(const uint32_t *src, size_t count)    { putArray(src, count, E_WriteLE32Array); }
+    void putUDWordArrayBE(const uint32_t *src, size_t count)  { putArray(src, count, E_WriteBE32Array); }
+    void putUQWordArray(const uint64_t *src, size_t count)    { putArray(src, count, E_WriteLE64Array); }
+    void putUQWordArrayBE(const uint64_t *src, size_t count)  { putArray(src, count, E_WriteBE64Array); }
+
+    //
+    // Write records described by an EBinaryLayout from binarylayout.h.
+    //
+    template<typename L>
+    void putRecord(const typename L::record_t &record)
+    {
+        require(L::Size);
+        L::Encode(take(L::Size), record);
+    }
+
+    template<typename L>
+    void putRecords(const typename L::record_t *records, size_t count)
+    {
+        const size_t n = requireArray(count, L::Size);
+        L::WriteArray(take(n), n, records, count);
+    }
+
+private:
+    ebyte *m_buffer   = nullptr;
+    size_t m_size     = 0;
+    size_t m_capacity = 0;
+
+    void   grow(size_t n);
+    size_t requireArray(size_t count, size_t size);
+
+    ebyte *take(size_t n)
+    {
+        eassert(n <= m_capacity - m_size);
+        ebyte *const at = m_buffer + m_size;
+        m_size += n;
+        return at;
+    }
+
+    template<typename T>
+    void putArray(const T *src, size_t count, void (*convert)(void *, const void *, size_t))
+    {
+        convert(take(requireArray(count, sizeof(T))), src, count);
+    }
+};
+
+// EOF
@@ -26,14 +26,23 @@
   SOFTWARE.
 */
 
-#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
 
 #include "elib.h"
 #include "econfig.h"
+#include "../hal/hal_filewatch.h"
 #include "../hal/hal_platform.h"
 #include "../hal/hal_ml.h"
 #include "atexit.h"
+#include "atom.h"
+#include "binary.h"
+#include "bytestream.h"
 #include "configfile.h"
+#include "mappedfile.h"
 #include "misc.h"
 #include "parser.h"
 #include "qstring.h"
@@ -45,58 +54,277 @@
 
 ECfgItem *ECfgItem::items[NUMCHAINS];
 
+EPerfectHashView ECfgItem::NameTable;
+ECfgItem       **ECfgItem::NamedItems;
+
+//
+// Config item names, interned ignoring case. Items are bound by static
+// constructors, so the table is created on first use.
+//
+static EAtomTable &ECfg_Atoms()
+{
+    static EAtomTable atoms(true);
+    return atoms;
+}
+
+//
+// Hash chain for an interned name.
+//
+static euint ECfg_AtomChain(const char *atom)
+{
+    return euint(reinterpret_cast<uintptr_t>(atom) % ECfgItem::NUMCHAINS);
+}
+
+//=============================================================================
+//
+// Epoch-based reclamation for ECfgValue<char *>
+//
+// Each thread that reads strings has a record holding the global epoch as it
+// was when its outermost read guard began, or 0 outside of guards. A replaced
+// string is retired under the epoch current at the time, which is then
+// advanced; it is freed once every reading thread has entered a later epoch
+// or left its guard, since only guards begun no later could have seen it.
+//
+
+struct cfgreader_t
+{
+    std::atomic<uint64_t> epoch { 0 };
+    unsigned int          depth = 0;  // guard nesting; touched only by the owner
+    cfgreader_t          *next  = nullptr;
+};
+
+struct cfgretired_t
+{
+    char    *str;
+    uint64_t epoch;
+};
+
+struct cfgepochs_t
+{
+    std::atomic<uint64_t>     epoch { 1 };
+    std::mutex                lock;      // guards readers and retired
+    cfgreader_t              *readers = nullptr;
+    std::vector<cfgretired_t> retired;
+};
+
+static cfgepochs_t &ECfg_Epochs()
+{
+    static cfgepochs_t epochs;
+    return epochs;
+}
+
+//
+// Owns the calling thread's reader record, unlinking it when the thread ends.
+//
+struct cfgreaderslot_t
+{
+    cfgreader_t *reader = nullptr;
+
+    ~cfgreaderslot_t()
+    {
+        if(!reader)
+            return;
+
+        cfgepochs_t &epochs = ECfg_Epochs();
+        std::lock_guard lock(epochs.lock);
+        for(cfgreader_t **link = &epochs.readers; *link; link = &(*link)->next)
+        {
+            if(*link == reader)
+            {
+                *link = reader->next;
+                break;
+            }
+        }
+        delete reader;
+    }
+};
+
+static thread_local cfgreaderslot_t ecfg_readerSlot;
+
+//
+// Reader record of the calling thread, created on its first guard.
+//
+static cfgreader_t *ECfg_Reader()
+{
+    if(cfgreader_t *const reader = ecfg_readerSlot.reader; reader)
+        return reader;
+
+    cfgreader_t *const reader = new cfgreader_t;
+    cfgepochs_t &epochs = ECfg_Epochs();
+    {
+        std::lock_guard lock(epochs.lock);
+        reader->next   = epochs.readers;
+        epochs.readers = reader;
+    }
+    return ecfg_readerSlot.reader = reader;
+}
+
+ECfgReadGuard::ECfgReadGuard() noexcept
+{
+    cfgreader_t *const reader = ECfg_Reader();
+    if(!reader->depth++)
+        reader->epoch.store(ECfg_Epochs().epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+ECfgReadGuard::~ECfgReadGuard()
+{
+    cfgreader_t *const reader = ecfg_readerSlot.reader;
+    if(!--reader->depth)
+        reader->epoch.store(0, std::memory_order_release);
+}
+
+//
+// Retire a replaced string, and free those no reader can still hold.
+//
+static void ECfg_Retire(char *str)
+{
+    cfgepochs_t &epochs = ECfg_Epochs();
+    std::lock_guard lock(epochs.lock);
+
+    epochs.retired.push_back({ str, epochs.epoch.fetch_add(1, std::memory_order_seq_cst) });
+
+    uint64_t oldest = UINT64_MAX;
+    for(const cfgreader_t *reader = epochs.readers; reader; reader = reader->next)
+    {
+        if(const uint64_t epoch = reader->epoch.load(std::memory_order_seq_cst); epoch && epoch < oldest)
+            oldest = epoch;
+    }
+
+    const auto freeable = [oldest](const cfgretired_t &retired) { return retired.epoch < oldest; };
+    for(const cfgretired_t &retired : epochs.retired)
+    {
+        if(freeable(retired))
+            efree(retired.str);
+    }
+    epochs.retired.erase(std::remove_if(epochs.retired.begin(), epochs.retired.end(), freeable),
+                                epochs.retired.end());
+}
+
+//
+// Publish a copy of a new string. The old one stays readable by guards that
+// may have seen it.
+//
+void ECfgValue<char *>::set(const char *value)
+{
+    char *const old = m_value.exchange(value ? estrdup(value) : nullptr, std::memory_order_seq_cst);
+    if(old)
+        ECfg_Retire(old);
+}
+
+//=============================================================================
+//
+// Value Access
+//
+// Items bind either plain variables or ECfgValues, which are only changed
+// through their own methods.
+//
+
+int ECfgItem::loadInt() const
+{
+    return m_shared ? static_cast<const ECfgValue<int> *>(m_var)->get() : *static_cast<const int *>(m_var);
+}
+
+bool ECfgItem::loadBool() const
+{
+    return m_shared ? static_cast<const ECfgValue<bool> *>(m_var)->get() : *static_cast<const bool *>(m_var);
+}
+
+double ECfgItem::loadDouble() const
+{
+    return m_shared ? static_cast<const ECfgValue<double> *>(m_var)->get() : *static_cast<const double *>(m_var);
+}
+
+//
+// Strings of shared values are read here without a guard, which is safe only
+// because they are changed by no thread but the caller's.
+//
+const char *ECfgItem::loadString() const
+{
+    return m_shared ? static_cast<const ECfgValue<char *> *>(m_var)->get() : *static_cast<char *const *>(m_var);
+}
+
 //
 // Set value to an integer config binding
 //
-static void ECfg_SetInt(void *var, int i, void *range)
+void ECfgItem::storeInt(int i)
 {
-    auto i_var = static_cast<int *>(var);
-    *i_var = i;
-    if(range)
-        *i_var = static_cast<ecfgrange_t<int> *>(range)->clamp(*i_var);
+    if(m_range)
+        i = static_cast<ecfgrange_t<int> *>(m_range)->clamp(i);
+    if(m_shared)
+        static_cast<ECfgValue<int> *>(m_var)->set(i);
+    else
+        *static_cast<int *>(m_var) = i;
 }
 
 //
 // Set value to a boolean config binding
 //
-static void ECfg_SetBool(void *var, bool b)
+void ECfgItem::storeBool(bool b)
 {
-    *static_cast<bool *>(var) = b;
+    if(m_shared)
+        static_cast<ECfgValue<bool> *>(m_var)->set(b);
+    else
+        *static_cast<bool *>(m_var) = b;
 }
 
-static void ECfg_SetDouble(void *var, double d, void *range)
+//
+// Set value to a double config binding
+//
+void ECfgItem::storeDouble(double d)
 {
-    auto d_var = static_cast<double *>(var);
-    *d_var = d;
-    if(range)
-        *d_var = static_cast<ecfgrange_t<double> *>(range)->clamp(*d_var);
+    if(m_range)
+        d = static_cast<ecfgrange_t<double> *>(m_range)->clamp(d);
+    if(m_shared)
+        static_cast<ECfgValue<double> *>(m_var)->set(d);
+    else
+        *static_cast<double *>(m_var) = d;
 }
 
 //
 // Set value to a string config binding
 //
-static void ECfg_SetString(void *var, const char *newvalue)
+void ECfgItem::storeString(const char *newvalue)
 {
-    char **dst = static_cast<char **>(var);
+    if(m_shared)
+    {
+        static_cast<ECfgValue<char *> *>(m_var)->set(newvalue);
+        return;
+    }
+
+    char **dst = static_cast<char **>(m_var);
     if(*dst)
         efree(*dst);
     *dst = newvalue ? estrdup(newvalue) : nullptr;
 }
 
+// set whenever an item is registered, so that the sorted list is rebuilt
+static bool ecfg_itemsChanged = true;
 
 //
 // Initialize a configuration binding completely.
 //
 void ECfgItem::init(const char *name, itemtype_t type, void *var)
 {
-   m_name  = name;
+   m_name  = ECfg_Atoms().intern(name);
    m_var   = var;
    m_type  = type;
    m_range = nullptr;
+   m_shared = false;
+   m_listed = false;
 
-   const euint chain = qstring::HashCodeStatic(name) % NUMCHAINS;
+   m_onChange   = nullptr;
+   m_changeData = nullptr;
+
+   const euint chain = ECfg_AtomChain(m_name);
    m_next = items[chain];
    items[chain] = this;
+   ecfg_itemsChanged = true;
+
+   if(NamedItems)
+   {
+      if(const int idx = NameTable.find(m_name); idx >= 0)
+         NamedItems[idx] = this;
+   }
 }
 
 //
@@ -136,7 +364,51 @@ ECfgItem::ECfgItem(const char *name, char **s, const char *pdefault /*= ""*/)
    init(name, CFG_STRING, s);
    m_default = pdefault;
    if(!estrempty(pdefault))
-       ECfg_SetString(m_var, pdefault);
+       storeString(pdefault);
+}
+
+//
+// Construct a thread-safe integer config binding.
+//
+ECfgItem::ECfgItem(const char *name, ECfgValue<int> *i, ecfgrange_t<int> *range)
+{
+   init(name, CFG_INT, i);
+   m_shared  = true;
+   m_range   = range;
+   m_default = i->get();
+}
+
+//
+// Construct a thread-safe boolean config binding.
+//
+ECfgItem::ECfgItem(const char *name, ECfgValue<bool> *b)
+{
+   init(name, CFG_BOOL, b);
+   m_shared  = true;
+   m_default = b->get();
+}
+
+//
+// Construct a thread-safe double config binding.
+//
+ECfgItem::ECfgItem(const char *name, ECfgValue<double> *d, ecfgrange_t<double> *range)
+{
+   init(name, CFG_DOUBLE, d);
+   m_shared  = true;
+   m_range   = range;
+   m_default = d->get();
+}
+
+//
+// Construct a thread-safe string config binding.
+//
+ECfgItem::ECfgItem(const char *name, ECfgValue<char *> *s, const char *pdefault /*= ""*/)
+{
+   init(name, CFG_STRING, s);
+   m_shared  = true;
+   m_default = pdefault;
+   if(!estrempty(pdefault))
+       storeString(pdefault);
 }
 
 //
@@ -147,22 +419,64 @@ void ECfgItem::readItem(const qstring &qstr)
     switch(m_type)
     {
     case CFG_INT:
-        ECfg_SetInt(m_var, qstr.toInt(), m_range);
+        storeInt(qstr.toInt());
         break;
     case CFG_BOOL:
-        ECfg_SetBool(m_var, !!qstr.toInt());
+        storeBool(!!qstr.toInt());
         break;
     case CFG_DOUBLE:
-        ECfg_SetDouble(m_var, qstr.toDouble(nullptr), m_range);
+        storeDouble(qstr.toDouble(nullptr));
         break;
     case CFG_STRING:
-        ECfg_SetString(m_var, qstr.c_str());
+        storeString(qstr.c_str());
         break;
     default:
         break;
     }
 }
 
+//
+// Read a config item as readItem does, but only if doing so would change its
+// value. Returns true if the value changed.
+//
+bool ECfgItem::updateItem(const qstring &qstr)
+{
+    switch(m_type)
+    {
+    case CFG_INT:
+    {
+        int i = qstr.toInt();
+        if(m_range)
+            i = static_cast<ecfgrange_t<int> *>(m_range)->clamp(i);
+        if(i == loadInt())
+            return false;
+        break;
+    }
+    case CFG_BOOL:
+        if(!!qstr.toInt() == loadBool())
+            return false;
+        break;
+    case CFG_DOUBLE:
+    {
+        double d = qstr.toDouble(nullptr);
+        if(m_range)
+            d = static_cast<ecfgrange_t<double> *>(m_range)->clamp(d);
+        if(d == loadDouble())
+            return false;
+        break;
+    }
+    case CFG_STRING:
+        if(const char *const cur = loadString(); cur != nullptr && qstr == cur)
+            return false;
+        break;
+    default:
+        return false;
+    }
+
+    readItem(qstr);
+    return true;
+}
+
 //
 // Write out the current value of a config item.
 //
@@ -171,16 +485,28 @@ void ECfgItem::writeItem(qstring &qstr) const
    switch(m_type)
    {
    case CFG_INT:
-      qstr << *static_cast<int *>(m_var);
+      qstr << loadInt();
       break;
    case CFG_BOOL:
-      qstr << *static_cast<bool *>(m_var);
+      qstr << loadBool();
       break;
    case CFG_DOUBLE:
-      qstr << *static_cast<double *>(m_var);
+   {
+      // the shortest form that reads back as the same value, so that the text
+      // holds exactly what the binary cache does
+      const double d = loadDouble();
+      char buf[32];
+      for(int precision = 15; precision <= 17; precision++)
+      {
+         std::snprintf(buf, sizeof(buf), "%.*g", precision, d);
+         if(std::strtod(buf, nullptr) == d)
+            break;
+      }
+      qstr << buf;
       break;
+   }
    case CFG_STRING:
-      if(const char *const src = *static_cast<char **>(m_var); src != nullptr)
+      if(const char *const src = loadString(); src != nullptr)
          qstr << src;
       break;
    default:
@@ -196,16 +522,16 @@ void ECfgItem::resetToDefault()
     switch(m_type)
     {
     case CFG_INT:
-        *static_cast<int *>(m_var) = std::get<CFG_INT>(m_default);
+        storeInt(std::get<CFG_INT>(m_default));
         break;
     case CFG_BOOL:
-        *static_cast<bool *>(m_var) = std::get<CFG_BOOL>(m_default);
+        storeBool(std::get<CFG_BOOL>(m_default));
         break;
     case CFG_DOUBLE:
-        *static_cast<double *>(m_var) = std::get<CFG_DOUBLE>(m_default);
+        storeDouble(std::get<CFG_DOUBLE>(m_default));
         break;
     case CFG_STRING:
-        ECfg_SetString(m_var, std::get<CFG_STRING>(m_default));
+        storeString(std::get<CFG_STRING>(m_default));
         break;
     default:
         break;
@@ -221,16 +547,16 @@ int ECfgItem::toInt() const
     switch(m_type)
     {
     case CFG_INT:
-        val = *static_cast<int *>(m_var);
+        val = loadInt();
         break;
     case CFG_BOOL:
-        val = int(*static_cast<bool *>(m_var));
+        val = int(loadBool());
         break;
     case CFG_DOUBLE:
-        val = int(*static_cast<double *>(m_var));
+        val = int(loadDouble());
         break;
     case CFG_STRING:
-        if(const char *const chvar = *static_cast<char **>(m_var); chvar != nullptr)
+        if(const char *const chvar = loadString(); chvar != nullptr)
             val = std::atoi(chvar);
         break;
     default:
@@ -248,16 +574,16 @@ bool ECfgItem::toBool() const
     switch(m_type)
     {
     case CFG_INT:
-        b = !!(*static_cast<int *>(m_var));
+        b = !!(loadInt());
         break;
     case CFG_BOOL:
-        b = *static_cast<bool *>(m_var);
+        b = loadBool();
         break;
     case CFG_DOUBLE:
-        b = (*static_cast<double *>(m_var) != 0.0);
+        b = (loadDouble() != 0.0);
         break;
     case CFG_STRING:
-        if(const char *const chvar = *static_cast<char **>(m_var); chvar != nullptr)
+        if(const char *const chvar = loadString(); chvar != nullptr)
             b = !!std::atoi(chvar);
         break;
     default:
@@ -275,16 +601,16 @@ double ECfgItem::toDouble() const
     switch(m_type)
     {
     case CFG_INT:
-        d = double(*static_cast<int *>(m_var));
+        d = double(loadInt());
         break;
     case CFG_BOOL:
-        d = double(*static_cast<bool *>(m_var));
+        d = double(loadBool());
         break;
     case CFG_DOUBLE:
-        d = *static_cast<double *>(m_var);
+        d = loadDouble();
         break;
     case CFG_STRING:
-        if(const char *const chvar = *static_cast<char **>(m_var); chvar != nullptr)
+        if(const char *const chvar = loadString(); chvar != nullptr)
             d = std::strtod(chvar, nullptr);
         break;
     default:
@@ -309,16 +635,16 @@ void ECfgItem::setValue(int i)
     switch(m_type)
     {
     case CFG_INT:
-        ECfg_SetInt(m_var, i, m_range);
+        storeInt(i);
         break;
     case CFG_BOOL:
-        ECfg_SetBool(m_var, !!i);
+        storeBool(!!i);
         break;
     case CFG_DOUBLE:
-        ECfg_SetDouble(m_var, double(i), m_range);
+        storeDouble(double(i));
         break;
     case CFG_STRING:
-        ECfg_SetString(m_var, qstring::ToString(i).c_str());
+        storeString(qstring::ToString(i).c_str());
         break;
     default:
         break;
@@ -333,16 +659,16 @@ void ECfgItem::setValue(bool b)
     switch(m_type)
     {
     case CFG_INT:
-        ECfg_SetInt(m_var, int(b), m_range);
+        storeInt(int(b));
         break;
     case CFG_BOOL:
-        ECfg_SetBool(m_var, b);
+        storeBool(b);
         break;
     case CFG_DOUBLE:
-        ECfg_SetDouble(m_var, double(b), m_range);
+        storeDouble(double(b));
         break;
     case CFG_STRING:
-        ECfg_SetString(m_var, qstring::ToString(b).c_str());
+        storeString(qstring::ToString(b).c_str());
         break;
     default:
         break;
@@ -357,16 +683,16 @@ void ECfgItem::setValue(double d)
     switch(m_type)
     {
     case CFG_INT:
-        ECfg_SetInt(m_var, int(d), m_range);
+        storeInt(int(d));
         break;
     case CFG_BOOL:
-        ECfg_SetBool(m_var, d != 0.0);
+        storeBool(d != 0.0);
         break;
     case CFG_DOUBLE:
-        ECfg_SetDouble(m_var, d, m_range);
+        storeDouble(d);
         break;
     case CFG_STRING:
-        ECfg_SetString(m_var, qstring::ToString(d).c_str());
+        storeString(qstring::ToString(d).c_str());
         break;
     default:
         break;
@@ -382,16 +708,16 @@ void ECfgItem::setValue(const char *str)
     switch(m_type)
     {
     case CFG_INT:
-        ECfg_SetInt(m_var, std::atoi(nval), m_range);
+        storeInt(std::atoi(nval));
         break;
     case CFG_BOOL:
-        ECfg_SetBool(m_var, !!std::atoi(nval));
+        storeBool(!!std::atoi(nval));
         break;
     case CFG_DOUBLE:
-        ECfg_SetDouble(m_var, std::strtod(nval, nullptr), m_range);
+        storeDouble(std::strtod(nval, nullptr));
         break;
     case CFG_STRING:
-        ECfg_SetString(m_var, nval);
+        storeString(nval);
         break;
     default:
         break;
@@ -399,19 +725,62 @@ void ECfgItem::setValue(const char *str)
 }
 
 //
-// Find a configuration binding item by name.
+// Find a configuration binding item by its interned name.
 //
-ECfgItem *ECfgItem::FindByName(const char *name)
+ECfgItem *ECfgItem::FindByAtom(const char *atom)
 {
-   const euint chain = qstring::HashCodeStatic(name) % NUMCHAINS;
-   ECfgItem *item = items[chain];
+   ECfgItem *item = items[ECfg_AtomChain(atom)];
 
-   while(item && strcasecmp(name, item->m_name))
+   while(item && item->m_name != atom)
       item = item->m_next;
 
    return item;
 }
 
+//
+// Find a configuration binding item by name. Names in the build-time table
+// are resolved by it alone. Others go through the atom table, which rejects
+// names that were never bound without walking a chain.
+//
+ECfgItem *ECfgItem::FindByName(std::string_view name)
+{
+   if(NamedItems)
+   {
+      if(const int idx = NameTable.find(name); idx >= 0)
+         return NamedItems[idx];
+   }
+
+   const char *const atom = ECfg_Atoms().find(name);
+   return atom ? FindByAtom(atom) : nullptr;
+}
+
+//
+// Install the table of config names known at build time, binding any items
+// already registered under those names. The table must outlive its use.
+//
+void ECfgItem::SetNameTable(const EPerfectHashView &view)
+{
+   if(NamedItems)
+      efree(NamedItems);
+
+   NameTable  = view;
+   NamedItems = view.count ? ecalloc(ECfgItem *, view.count, sizeof(ECfgItem *)) : nullptr;
+
+   if(NamedItems)
+   {
+      // chains run from newest to oldest, and lookups find the newest item
+      // registered under a name, so only the first match fills a slot
+      for(ECfgItem *chain : items)
+      {
+         for(ECfgItem *item = chain; item; item = item->m_next)
+         {
+            if(const int idx = NameTable.find(item->m_name); idx >= 0 && !NamedItems[idx])
+               NamedItems[idx] = item;
+         }
+      }
+   }
+}
+
 //
 // Get a variable's string representation.
 //
@@ -464,16 +833,26 @@ protected:
    bool doStateExpectValue(ETokenizer &);
 
    // parser state data
-   int      m_state = STATE_EXPECTKEYWORD;
-   qstring  m_key;
+   int       m_state = STATE_EXPECTKEYWORD;
+   ECfgItem *m_item  = nullptr; // item bound to the current key, if any
+
+   // when reloading, only items whose values differ are set
+   bool m_reload;
+
+   // receives each item set, if provided
+   std::vector<ECfgItem *> *m_items;
 
    // overrides
    virtual bool doToken(ETokenizer &token) override;
    virtual void startFile() override;
    virtual void initTokenizer(ETokenizer &token) override;
+   virtual void onEOF(bool early) override;
 
 public:
-    using EParser::EParser;
+   ECfgFileParser(const char *filename, bool reload = false, std::vector<ECfgItem *> *items = nullptr)
+      : EParser(filename), m_reload(reload), m_items(items)
+   {
+   }
 };
 
 // state table
@@ -497,7 +876,7 @@ bool ECfgFileParser::doToken(ETokenizer &token)
 void ECfgFileParser::startFile()
 {
    m_state = STATE_EXPECTKEYWORD;
-   m_key   = "";
+   m_item  = nullptr;
 }
 
 //
@@ -508,6 +887,18 @@ void ECfgFileParser::initTokenizer(ETokenizer &token)
    token.setTokenFlags(ETokenizer::TF_DEFAULT);
 }
 
+//
+// Clear the marks left on the collected items, ready for the next load.
+//
+void ECfgFileParser::onEOF(bool)
+{
+   if(m_items)
+   {
+      for(ECfgItem *item : *m_items)
+         item->m_listed = false;
+   }
+}
+
 //
 // Keyword state handler
 //
@@ -520,7 +911,7 @@ bool ECfgFileParser::doStateExpectKeyword(ETokenizer &token)
    case ETokenizer::TOKEN_KEYWORD:
    case ETokenizer::TOKEN_STRING:
       // record as the current key and expect value to follow
-      m_key   = token.getToken();
+      m_item  = ECfgItem::FindByName(token.getTokenView());
       m_state = STATE_EXPECTVALUE;
       break;
    default:
@@ -536,12 +927,24 @@ bool ECfgFileParser::doStateExpectKeyword(ETokenizer &token)
 //
 bool ECfgFileParser::doStateExpectValue(ETokenizer &token)
 {
-   qstring &value = token.getToken();
+   // only values for bound keys need to be copied out of the input
+   if(m_item)
+   {
+      bool set = true;
+      if(!m_reload)
+         m_item->readItem(token.getToken());
+      else
+         set = m_item->updateItem(token.getToken());
 
-   if(ECfgItem *const item = ECfgItem::FindByName(m_key.c_str()); item != nullptr)
-      item->readItem(value);
+      // an item is collected once, however often its key repeats
+      if(set && m_items && !m_item->m_listed)
+      {
+         m_item->m_listed = true;
+         m_items->push_back(m_item);
+      }
+   }
    m_state = STATE_EXPECTKEYWORD;
-   m_key   = "";
+   m_item  = nullptr;
 
    return true;
 }
@@ -551,96 +954,463 @@ bool ECfgFileParser::doStateExpectValue(ETokenizer &token)
 // External Interface
 //
 
+//
+// Full path of the configuration file.
+//
+static qstring ECfg_FileName()
+{
+    return qstring(hal_medialayer.getWriteDirectory(ELIB_APP_NAME)) / ELIB_CFG_NAME;
+}
+
+//
+// All items, sorted by name, and rebuilt only after an item is registered.
+// Where several items share a name, only the one lookups find, which is the
+// most recently registered and so the first on its chain, is kept.
+//
+static const std::vector<ECfgItem *> &ECfg_SortedItems()
+{
+    static std::vector<ECfgItem *> sorted;
+
+    if(!ecfg_itemsChanged)
+        return sorted;
+
+    sorted.clear();
+    ECfgItem::ItemIterator([](ECfgItem *item, void *data) {
+        static_cast<std::vector<ECfgItem *> *>(data)->push_back(item);
+    }, &sorted);
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const ECfgItem *a, const ECfgItem *b) {
+        return std::strcmp(a->getName(), b->getName()) < 0;
+    });
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const ECfgItem *a, const ECfgItem *b) {
+        return !std::strcmp(a->getName(), b->getName());
+    }), sorted.end());
+
+    ecfg_itemsChanged = false;
+    return sorted;
+}
+
+#if defined(ELIB_CFG_CACHE_NAME)
+
+//=============================================================================
+//
+// Binary Cache
+//
+// A snapshot of the values set by the text file, so that startup can skip
+// parsing it. The text file stays canonical: the cache is used only while the
+// text file has the size recorded for it, and either the same mtime or, if it
+// was merely touched, the same content hash, and only while the same names
+// and types are registered, since the file is read only for bound keys.
+// Everything is little-endian:
+//
+//   "ECFC", version, text size (8), text mtime (8), text hash (8),
+//   registered items hash (8), entry count, payload size, payload hash (8),
+//   payload
+//
+// Each entry is a name (UWord length and bytes), the item type as a byte, and
+// the value: a byte for bools, a DWord for ints, a little-endian double, or a
+// UDWord length and bytes for strings.
+//
+
+static constexpr char     ECFG_CACHE_MAGIC[4]   = { 'E', 'C', 'F', 'C' };
+static constexpr uint32_t ECFG_CACHE_VERSION    = 2;
+static constexpr size_t   ECFG_CACHE_HEADERSIZE = 56;
+
+static qstring ECfg_CacheName()
+{
+    return qstring(hal_medialayer.getWriteDirectory(ELIB_APP_NAME)) / ELIB_CFG_CACHE_NAME;
+}
+
+//
+// Hash of the name and type of every registered item.
+//
+static uint64_t ECfg_ItemsHash()
+{
+    EByteWriter keys(1024);
+    for(const ECfgItem *const item : ECfg_SortedItems())
+    {
+        const char *const name = item->getName();
+        const size_t      size = std::strlen(name) + 1;
+
+        keys.require(size + 1);
+        keys.putBytes(name, size);
+        keys.putByte(ebyte(item->getType()));
+    }
+    return M_HashBytes(keys.getData(), keys.getSize());
+}
+
+//
+// Write the cache for the current text file, holding the current values of
+// the given items.
+//
+static void ECfg_WriteCache(const char *textName, const std::vector<ECfgItem *> &items)
+{
+    uint64_t textSize;
+    int64_t  textTime;
+    if(!hal_platform.fileStat || !hal_platform.fileStat(textName, &textSize, &textTime))
+        return;
+
+    const EMappedFile text(textName);
+    if(!text.isOpen() || text.getSize() != textSize)
+        return;
+
+    EByteWriter out(4096);
+    out.putSpace(ECFG_CACHE_HEADERSIZE);
+
+    uint32_t count = 0;
+    for(const ECfgItem *const item : items)
+    {
+        const char *const name    = item->getName();
+        const size_t      nameLen = std::strlen(name);
+        if(nameLen > UINT16_MAX)
+            continue;
+
+        out.require(2);
+        out.putUWord(uint16_t(nameLen));
+        out.putBytes(name, nameLen);
+        out.require(9);
+        out.putByte(ebyte(item->getType()));
+
+        switch(item->getType())
+        {
+        case ECfgItem::CFG_BOOL:
+            out.putByte(item->toBool() ? 1 : 0);
+            break;
+        case ECfgItem::CFG_INT:
+            out.putDWord(item->toInt());
+            break;
+        case ECfgItem::CFG_DOUBLE:
+            out.putDouble(item->toDouble());
+            break;
+        case ECfgItem::CFG_STRING:
+        {
+            qstring value;
+            item->toString(value);
+            out.putUDWord(uint32_t(value.length()));
+            out.putBytes(value.c_str(), value.length());
+            break;
+        }
+        }
+        ++count;
+    }
+
+    const size_t payloadSize = out.getSize() - ECFG_CACHE_HEADERSIZE;
+
+    ebyte *p = out.getData();
+    E_PutBinaryString(&p, ECFG_CACHE_MAGIC, sizeof(ECFG_CACHE_MAGIC));
+    E_PutBinaryUDWord(&p, ECFG_CACHE_VERSION);
+    E_PutBinaryUQWord(&p, textSize);
+    E_PutBinaryUQWord(&p, uint64_t(textTime));
+    E_PutBinaryUQWord(&p, M_HashBytes(text.getData(), text.getSize()));
+    E_PutBinaryUQWord(&p, ECfg_ItemsHash());
+    E_PutBinaryUDWord(&p, count);
+    E_PutBinaryUDWord(&p, uint32_t(payloadSize));
+    E_PutBinaryUQWord(&p, M_HashBytes(out.getData() + ECFG_CACHE_HEADERSIZE, payloadSize));
+
+    const qstring cacheName = ECfg_CacheName();
+    if(const EAutoFile f(hal_platform.fileOpen(cacheName.c_str(), "wb")); f)
+    {
+        if(std::fwrite(out.getData(), 1, out.getSize(), f.get()) == out.getSize())
+            return;
+    }
+    std::remove(cacheName.c_str());
+}
+
+//
+// Apply the cache if it is fresh for the text file. Returns false if the
+// text file must be parsed instead; any values already applied are then
+// overwritten, since every entry came from that file.
+//
+static bool ECfg_LoadCache(const char *textName)
+{
+    uint64_t textSize;
+    int64_t  textTime;
+    if(!hal_platform.fileStat || !hal_platform.fileStat(textName, &textSize, &textTime))
+        return false;
+
+    const qstring     cacheName = ECfg_CacheName();
+    const EMappedFile cache(cacheName.c_str());
+    if(!cache.isOpen())
+        return false;
+
+    EByteReader in(cache.getData(), cache.getSize());
+    if(!in.require(ECFG_CACHE_HEADERSIZE) ||
+       std::memcmp(in.getBytes(sizeof(ECFG_CACHE_MAGIC)), ECFG_CACHE_MAGIC, sizeof(ECFG_CACHE_MAGIC)))
+        return false;
+    if(in.getUDWord() != ECFG_CACHE_VERSION)
+        return false;
+
+    const uint64_t cachedSize  = in.getUQWord();
+    const int64_t  cachedTime  = in.getQWord();
+    const uint64_t cachedHash  = in.getUQWord();
+    const uint64_t itemsHash   = in.getUQWord();
+    const uint32_t count       = in.getUDWord();
+    const size_t   payloadSize = in.getUDWord();
+    const uint64_t payloadHash = in.getUQWord();
+
+    if(cachedSize != textSize || itemsHash != ECfg_ItemsHash() || payloadSize != in.remaining() ||
+       M_HashBytes(in.getCursor(), payloadSize) != payloadHash)
+        return false;
+
+    if(cachedTime != textTime)
+    {
+        const EMappedFile text(textName);
+        if(!text.isOpen() || M_HashBytes(text.getData(), text.getSize()) != cachedHash)
+            return false;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(!in.require(2))
+            return false;
+        const std::string_view name = in.getView(in.getUWord());
+        if(!in.require(1))
+            return false;
+        const int type = in.getByte();
+
+        // an item that changed type since would read the text differently
+        ECfgItem *const item = ECfgItem::FindByName(name);
+        if(item && item->getType() != type)
+            return false;
+
+        switch(type)
+        {
+        case ECfgItem::CFG_BOOL:
+            if(!in.require(1))
+                return false;
+            if(const bool b = in.getByte() != 0; item)
+                item->setValue(b);
+            break;
+        case ECfgItem::CFG_INT:
+            if(!in.require(4))
+                return false;
+            if(const int i = in.getDWord(); item)
+                item->setValue(i);
+            break;
+        case ECfgItem::CFG_DOUBLE:
+            if(!in.require(8))
+                return false;
+            if(const double d = in.getDouble(); item)
+                item->setValue(d);
+            break;
+        case ECfgItem::CFG_STRING:
+        {
+            if(!in.require(4))
+                return false;
+            const std::string_view value = in.getView(in.getUDWord());
+            if(in.failed())
+                return false;
+            if(item)
+                item->setValue(qstring(value).c_str());
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+
+    return !in.failed() && in.atEnd();
+}
+
+#endif
+
 void E_CfgLoadFile()
 {
-    const char *const pGameName = ELIB_APP_NAME;
-    const char *const pCfgName  = ELIB_CFG_NAME;
+    const qstring fn = ECfg_FileName();
 
-    const qstring fn = qstring(hal_medialayer.getWriteDirectory(pGameName)) / pCfgName;
+#if defined(ELIB_CFG_CACHE_NAME)
+    if(!ECfg_LoadCache(fn.c_str()))
+    {
+        std::vector<ECfgItem *> loaded;
+        ECfgFileParser parser(fn.c_str(), false, &loaded);
+        parser.parseFile();
+        ECfg_WriteCache(fn.c_str(), loaded);
+    }
+#else
     ECfgFileParser parser(fn.c_str());
     parser.parseFile();
+#endif
 
     // schedule to write config file at exit, except in case of errors
     E_AtExit(E_CfgWriteFile, false);
 }
 
-using cfgitemmap_t = std::map<qstring, ECfgItem *>;
-
-struct cfgwritedata_t
+// What was last written to the config file, to recognize unchanged output
+struct cfgwritten_t
 {
-    cfgitemmap_t *itemMap;
+    bool     known;
+    uint64_t hash;
+    uint64_t size;
+    int64_t  mtime;
 };
 
-static void AddItemToMap(ECfgItem *item, void *data)
+static cfgwritten_t ecfg_written;
+
+//
+// Format every item into one buffer.
+//
+static void ECfg_FormatFile(qstring &buffer, const std::vector<ECfgItem *> &items)
 {
-   const auto cwd = static_cast<cfgwritedata_t *>(data);
-   cwd->itemMap->emplace(qstring(item->getName()), item);
+    buffer << "// " << ELIB_APP_NAME << " configuration file\n";
+    for(const ECfgItem *const item : items)
+    {
+        buffer << item->getName() << " \"";
+        item->writeItem(buffer);
+        buffer << "\"\n";
+    }
 }
 
-static bool WriteCfgItem(const ECfgItem *item, FILE *f)
+//
+// True if the file already holds exactly the formatted contents. A file that
+// has not been touched since it was last written is judged by hash alone.
+//
+static bool ECfg_FileMatches(const char *path, const qstring &buffer, uint64_t hash)
 {
-   qstring value;
-   item->writeItem(value);
-   if(std::fprintf(f, "%s \"%s\"\n", item->getName(), value.c_str()) < 0)
-      return false;
-   return true;
+    uint64_t size;
+    int64_t  mtime;
+    if(!hal_platform.fileStat || !hal_platform.fileStat(path, &size, &mtime) || size != buffer.length())
+        return false;
+
+    if(ecfg_written.known && ecfg_written.size == size && ecfg_written.mtime == mtime)
+        return ecfg_written.hash == hash;
+
+    const EMappedFile file(path);
+    return file.isOpen() && file.getSize() == size && !std::memcmp(file.getData(), buffer.c_str(), size);
 }
 
+//
+// Write a file without going through the atomic HAL path, for platforms
+// that lack one. The rename replaces the file atomically where the C library
+// allows it; only where it refuses to replace an existing file is the old one
+// removed first.
+//
+static bool ECfg_WriteFileFallback(const char *path, const qstring &buffer)
+{
+    const qstring tmpName = qstring(path) + ".tmp";
+
+    FILE *const f = hal_platform.fileOpen(tmpName.c_str(), "wb");
+    if(!f)
+        return false;
+
+    const bool written = std::fwrite(buffer.c_str(), 1, buffer.length(), f) == buffer.length();
+    if(std::fclose(f) || !written)
+    {
+        std::remove(tmpName.c_str());
+        return false;
+    }
+
+    if(!std::rename(tmpName.c_str(), path))
+        return true;
+
+    std::remove(path);
+    if(!std::rename(tmpName.c_str(), path))
+        return true;
+
+    std::remove(tmpName.c_str());
+    return false;
+}
+
+//
+// Write out the config file, unless it already holds what would be written.
+//
 void E_CfgWriteFile()
 {
-    const char *const  pGameName = ELIB_APP_NAME;
-    const char *const  pCfgName  = ELIB_CFG_NAME;
-    const char *const  pWriteDir = hal_medialayer.getWriteDirectory(pGameName);
+    const qstring fn = ECfg_FileName();
 
-    const qstring tmpName = qstring(pWriteDir) / "temp.cfg";
-    const qstring dstName = qstring(pWriteDir) / pCfgName;
+    const std::vector<ECfgItem *> &items = ECfg_SortedItems();
 
-    cfgwritedata_t cwd;
-    cfgitemmap_t   items;
-    cwd.itemMap = &items;
+    qstring buffer(4096);
+    ECfg_FormatFile(buffer, items);
 
-    FILE *const f = hal_platform.fileOpen(tmpName.c_str(), "w");
-    if(!f)
-    {
-        hal_platform.debugMsg("Warning: could not open temp.cfg\n");
+    const uint64_t hash = M_HashBytes(buffer.c_str(), buffer.length());
+    if(ECfg_FileMatches(fn.c_str(), buffer, hash))
         return;
-    }
-    
-    if(std::fprintf(f, "// %s configuration file\n", pGameName) < 0)
+
+    const bool written = hal_platform.writeFileAtomic ?
+        hal_platform.writeFileAtomic(fn.c_str(), buffer.c_str(), buffer.length()) == HAL_TRUE :
+        ECfg_WriteFileFallback(fn.c_str(), buffer);
+
+    if(!written)
     {
-        hal_platform.debugMsg("Warning: failed write to temp.cfg\n");
+        hal_platform.debugMsg("Warning: failed to write %s\n", ELIB_CFG_NAME);
+        ecfg_written.known = false;
         return;
     }
-    
-    // add config items to the map
-    ECfgItem::ItemIterator(AddItemToMap, &cwd);
-    
-    bool error = false;
-    for(const auto &item : items)
+
+    ecfg_written.known = hal_platform.fileStat && 
+                         hal_platform.fileStat(fn.c_str(), &ecfg_written.size, &ecfg_written.mtime);
+    ecfg_written.hash  = hash;
+
+#if defined(ELIB_CFG_CACHE_NAME)
+    // the file now sets every item
+    ECfg_WriteCache(fn.c_str(), items);
+#endif
+}
+
+//=============================================================================
+//
+// Reloading
+//
+
+static hal_watch_t *ecfg_watch;
+
+//
+// Begin watching the configuration file for changes made outside the program.
+//
+void E_CfgWatchFile()
+{
+    static bool atExitAdded;
+
+    if(ecfg_watch)
+        return;
+
+    if(!(ecfg_watch = hal_filewatch.watchFile(ECfg_FileName().c_str())))
     {
-        if(!WriteCfgItem(item.second, f))
-        {
-            error = true;
-            break;
-        }
+        hal_platform.debugMsg("Warning: cannot watch config file for changes\n");
+        return;
     }
-    
-    if(error)
+
+    if(!atExitAdded)
     {
-        std::fclose(f);
-        hal_platform.debugMsg("Warning: failed one or more cfg writes\n");
-        return;
+        E_AtExit(E_CfgUnwatchFile, true);
+        atExitAdded = true;
     }
-    
-    if(std::fclose(f) < 0)
+}
+
+//
+// Stop watching the configuration file.
+//
+void E_CfgUnwatchFile()
+{
+    if(ecfg_watch)
     {
-        hal_platform.debugMsg("Warning: failed to close temp.cfg\n");
-        return;
+        hal_filewatch.closeWatch(ecfg_watch);
+        ecfg_watch = nullptr;
     }
-    
-    std::remove(dstName.c_str());
-    if(std::rename(tmpName.c_str(), dstName.c_str()))
-        hal_platform.debugMsg("Warning: failed to write %s\n", pCfgName);
+}
+
+//
+// Call periodically while the configuration file is watched. If the file has
+// changed, it is parsed again and only items whose values differ are set;
+// their change callbacks are then called, in the order the items appear in
+// the file. Items missing from the file keep their values, as they do when
+// it is first loaded. Returns the number of items changed.
+//
+int E_CfgCheckReload()
+{
+    if(!ecfg_watch || !hal_filewatch.fileChanged(ecfg_watch))
+        return 0;
+
+    std::vector<ECfgItem *> changed;
+
+    const qstring fn = ECfg_FileName();
+    ECfgFileParser parser(fn.c_str(), true, &changed);
+    parser.parseFile();
+
+    for(ECfgItem *const item : changed)
+        item->notifyChange();
+
+    return int(changed.size());
 }
 
 // EOF
@@ -30,8 +30,12 @@
 
 #if defined(__cplusplus)
 
+#include <atomic>
+#include <string_view>
+#include <type_traits>
 #include <variant>
 #include "compare.h"
+#include "perfecthash.h"
 
 class qstring;
 
@@ -46,6 +50,68 @@ struct ecfgrange_t
    }
 };
 
+//
+// A config value that other threads may read while the config file is
+// reloaded or items are set. Bind it to an ECfgItem in place of a plain
+// variable; reads are atomic loads.
+//
+template<typename T>
+class ECfgValue
+{
+   static_assert(std::is_same_v<T, int> || std::is_same_v<T, bool> || std::is_same_v<T, double>,
+                 "ECfgValue holds int, bool, double, or char *");
+
+   std::atomic<T> m_value;
+
+public:
+   constexpr ECfgValue(T value = T()) : m_value(value) {}
+   ECfgValue(const ECfgValue &) = delete;
+   ECfgValue &operator = (const ECfgValue &) = delete;
+
+   T get() const { return m_value.load(std::memory_order_acquire); }
+   operator T () const { return get(); }
+
+   void set(T value) { m_value.store(value, std::memory_order_release); }
+};
+
+//
+// Marks a span in which the calling thread reads ECfgValue<char *> strings.
+// A string read inside the guard stays valid until the guard ends, even if
+// the value is replaced meanwhile. Guards nest, and are cheap to begin.
+//
+class ECfgReadGuard
+{
+public:
+   ECfgReadGuard() noexcept;
+   ~ECfgReadGuard();
+   ECfgReadGuard(const ECfgReadGuard &) = delete;
+   ECfgReadGuard &operator = (const ECfgReadGuard &) = delete;
+};
+
+//
+// A string config value. A replaced string is freed only once no thread
+// still inside a read guard can hold it, so readers on other threads must
+// use get() within an ECfgReadGuard and not keep the pointer past it.
+//
+template<>
+class ECfgValue<char *>
+{
+   std::atomic<char *> m_value { nullptr };
+
+public:
+   constexpr ECfgValue() = default;
+   ECfgValue(const ECfgValue &) = delete;
+   ECfgValue &operator = (const ECfgValue &) = delete;
+
+   const char *get() const { return m_value.load(std::memory_order_seq_cst); }
+
+   void set(const char *value);
+};
+
+//
+// Items are read, set, and reloaded by one thread at a time, which may read
+// the strings of values it binds without a guard.
+//
 class ECfgItem
 {
 public:
@@ -59,8 +125,15 @@ public:
 
    enum chains_e { NUMCHAINS = 257 };
 
+   // called after a reload changes the item's value
+   using changefunc_t = void (*)(ECfgItem *item, void *data);
+
 protected:
    static ECfgItem *items[NUMCHAINS];
+
+   // names known at build time, and the items bound to them
+   static EPerfectHashView NameTable;
+   static ECfgItem       **NamedItems;
    const char *m_name;
    ECfgItem   *m_next;
    itemtype_t  m_type;
@@ -70,15 +143,38 @@ protected:
    using default_t = std::variant<bool, int, double, const char *>;
    default_t   m_default;
 
+   changefunc_t m_onChange;
+   void        *m_changeData;
+   bool         m_shared;     // m_var is an ECfgValue
+   bool         m_listed;     // already collected by the file being parsed
+
+   friend class ECfgFileParser;
+
    void init(const char *name, itemtype_t type, void *var);
 
+   int         loadInt()    const;
+   bool        loadBool()   const;
+   double      loadDouble() const;
+   const char *loadString() const;
+
+   void storeInt(int i);
+   void storeBool(bool b);
+   void storeDouble(double d);
+   void storeString(const char *newvalue);
+
 public:
    ECfgItem(const char *name, int     *i, ecfgrange_t<int> *range = nullptr);
    ECfgItem(const char *name, bool    *b);
    ECfgItem(const char *name, double  *d, ecfgrange_t<double> *range = nullptr);
    ECfgItem(const char *name, char   **s, const char *pdefault = "");
 
+   ECfgItem(const char *name, ECfgValue<int>    *i, ecfgrange_t<int> *range = nullptr);
+   ECfgItem(const char *name, ECfgValue<bool>   *b);
+   ECfgItem(const char *name, ECfgValue<double> *d, ecfgrange_t<double> *range = nullptr);
+   ECfgItem(const char *name, ECfgValue<char *> *s, const char *pdefault = "");
+
    void readItem(const qstring &qstr);
+   bool updateItem(const qstring &qstr);
    void writeItem(qstring &qstr) const;
    void resetToDefault();
 
@@ -95,9 +191,27 @@ public:
    itemtype_t  getType() const { return m_type; }
    const char *getName() const { return m_name; }
 
-   static ECfgItem *FindByName(const char *name);
+   void setChangeCallback(changefunc_t func, void *data = nullptr)
+   {
+      m_onChange   = func;
+      m_changeData = data;
+   }
+   void notifyChange() { if(m_onChange) m_onChange(this, m_changeData); }
+
+   static ECfgItem *FindByName(std::string_view name);
+   static ECfgItem *FindByAtom(const char *atom);
    static void GetValueAsString(const char *name, qstring &qstr);
    static void ItemIterator(void (*func)(ECfgItem *, void *), void *data);
+
+   // Install a perfect hash over the config names known at build time, e.g.
+   //    static constexpr const char *names[] = { "screen_width", ... };
+   //    static constexpr EPerfectHashTable<std::size(names)> nameTable(names);
+   //    ECfgItem::SetNameTable(nameTable);
+   // Lookups of those names then need one hash and one compare. Items may be
+   // bound before or after, and items with other names are still found.
+   template<size_t N>
+   static void SetNameTable(const EPerfectHashTable<N> &table) { SetNameTable(table.getView()); }
+   static void SetNameTable(const EPerfectHashView &view);
 };
 
 extern "C" {
@@ -106,6 +220,10 @@ extern "C" {
 void E_CfgLoadFile(void);
 void E_CfgWriteFile(void);
 
+void E_CfgWatchFile(void);
+void E_CfgUnwatchFile(void);
+int  E_CfgCheckReload(void);
+
 #if defined(__cplusplus)
 }
 #endif
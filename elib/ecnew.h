@@ -32,6 +32,12 @@
 
 #include "../hal/hal_platform.h"
 
+//
+// Types deriving from EPoolAllocated are served from the small-object pool
+// by both of these functions, and must then be released with delete/delete[]
+// as usual.
+//
+
 template<typename T, typename... Args>
 T *ecnew(Args ...args) noexcept
 {
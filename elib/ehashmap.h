@@ -0,0 +1,408 @@
+/*
+  ELib
+
+  Open-addressing hash map
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "elib.h"
+#include "qstring.h"
+
+// Detects the is_transparent marker on a hasher or key comparator.
+template<typename T, typename = void>
+struct EIsTransparent : std::false_type {};
+
+template<typename T>
+struct EIsTransparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+//
+// Open-addressing hash map using Robin Hood probing. Entries live in a single
+// contiguous array of slots, each of which caches its key's hash and its
+// distance from the ideal position. Insertion displaces entries that are
+// closer to home than the one being placed, which keeps probe lengths short
+// and lets lookups stop early on a miss. Deletion shifts the following run
+// back rather than leaving tombstones.
+//
+// When both the hasher and the key comparator declare is_transparent, the
+// lookup methods accept any type they can be called with, so for example a
+// map keyed by qstring can be searched with a C string or string view without
+// building a temporary key. See EQStrHashMap and EQStrNoCaseHashMap below.
+//
+// Pointers to values are invalidated by any insertion or erasure. Keys reached
+// through iteration must not be modified.
+//
+template<typename K, typename V, typename H = std::hash<K>, typename E = std::equal_to<K>>
+class EHashMap
+{
+public:
+    using value_type = std::pair<K, V>;
+
+private:
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    static constexpr bool transparent = EIsTransparent<H>::value && EIsTransparent<E>::value;
+
+    // Type through which a lookup key of type L is passed to the functors
+    template<typename L>
+    using lookup_t = std::conditional_t<transparent, std::decay_t<const L &>, K>;
+
+    struct slot_t
+    {
+        unsigned int dist; // 0 if empty, otherwise probe distance + 1
+        size_t       hash;
+        alignas(value_type) unsigned char storage[sizeof(value_type)];
+
+        value_type &entry() { return *std::launder(reinterpret_cast<value_type *>(storage)); }
+    };
+
+    slot_t  *m_slots    = nullptr;
+    size_t   m_capacity = 0; // always 0 or a power of two
+    size_t   m_size     = 0;
+    unsigned m_shift    = 64;
+    H        m_hasher;
+    E        m_equal;
+
+    //
+    // Home slot for a hash. Fibonacci hashing takes the top bits of the product
+    // so that hashers with weak low bits, such as identity hashes of integers,
+    // still spread across the table.
+    //
+    size_t indexFor(size_t hash) const
+    {
+        return size_t((uint64_t(hash) * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+    template<typename L>
+    slot_t *findSlot(const L &key, size_t hash) const
+    {
+        if(!m_size)
+            return nullptr;
+
+        const size_t mask = m_capacity - 1;
+        size_t       idx  = indexFor(hash);
+
+        for(unsigned int dist = 1; ; ++dist)
+        {
+            slot_t &slot = m_slots[idx];
+
+            // An empty slot, or one holding an entry nearer its home than we
+            // are to ours, means the key would have been placed before here.
+            if(slot.dist < dist)
+                return nullptr;
+            if(slot.hash == hash && m_equal(slot.entry().first, key))
+                return &slot;
+
+            idx = (idx + 1) & mask;
+        }
+    }
+
+    //
+    // Place an entry known not to be present, and return where it landed.
+    // There must be at least one free slot.
+    //
+    value_type *insertNew(size_t hash, value_type entry)
+    {
+        const size_t mask   = m_capacity - 1;
+        size_t       idx    = indexFor(hash);
+        unsigned int dist   = 1;
+        value_type  *result = nullptr;
+
+        for(;; ++dist, idx = (idx + 1) & mask)
+        {
+            slot_t &slot = m_slots[idx];
+
+            if(!slot.dist)
+            {
+                ::new(slot.storage) value_type(std::move(entry));
+                slot.dist = dist;
+                slot.hash = hash;
+                ++m_size;
+                return result ? result : &slot.entry();
+            }
+            if(slot.dist < dist)
+            {
+                // Take the slot from the richer entry and carry it onward
+                std::swap(slot.hash, hash);
+                std::swap(slot.dist, dist);
+                std::swap(slot.entry(), entry);
+                if(!result)
+                    result = &slot.entry();
+            }
+        }
+    }
+
+    void rehash(size_t newCapacity)
+    {
+        slot_t *const oldSlots    = m_slots;
+        const size_t  oldCapacity = m_capacity;
+
+        m_slots    = ecalloc(slot_t, newCapacity, sizeof(slot_t));
+        m_capacity = newCapacity;
+        m_size     = 0;
+        m_shift    = 64;
+        for(size_t c = newCapacity; c > 1; c >>= 1)
+            --m_shift;
+
+        for(size_t i = 0; i < oldCapacity; i++)
+        {
+            slot_t &slot = oldSlots[i];
+            if(slot.dist)
+            {
+                insertNew(slot.hash, std::move(slot.entry()));
+                slot.entry().~value_type();
+            }
+        }
+
+        if(oldSlots)
+            efree(oldSlots);
+    }
+
+    // Maximum load is 80%.
+    static size_t CapacityFor(size_t count)
+    {
+        size_t capacity = MIN_CAPACITY;
+        while(capacity * 4 < count * 5)
+            capacity *= 2;
+        return capacity;
+    }
+
+    template<typename S, typename T>
+    class iterator_t
+    {
+    public:
+        iterator_t(S *slot, S *end) : m_slot(slot), m_end(end) { skip(); }
+
+        T &operator *  () const { return m_slot->entry(); }
+        T *operator -> () const { return &m_slot->entry(); }
+
+        iterator_t &operator ++ () { ++m_slot; skip(); return *this; }
+
+        bool operator == (const iterator_t &other) const { return m_slot == other.m_slot; }
+        bool operator != (const iterator_t &other) const { return m_slot != other.m_slot; }
+
+    private:
+        S *m_slot;
+        S *m_end;
+
+        void skip() { while(m_slot != m_end && !m_slot->dist) ++m_slot; }
+    };
+
+public:
+    using iterator       = iterator_t<slot_t, value_type>;
+    using const_iterator = iterator_t<slot_t, const value_type>;
+
+    EHashMap() = default;
+
+    explicit EHashMap(size_t initialCount) { reserve(initialCount); }
+
+    // For stateful hashers and comparators
+    EHashMap(size_t initialCount, const H &hasher, const E &equal)
+        : m_hasher(hasher), m_equal(equal)
+    {
+        reserve(initialCount);
+    }
+
+    EHashMap(EHashMap &&other) noexcept { swapWith(other); }
+
+    EHashMap &operator = (EHashMap &&other) noexcept
+    {
+        if(this != &other)
+        {
+            EHashMap tmp(std::move(other));
+            swapWith(tmp);
+        }
+        return *this;
+    }
+
+    // not copyable
+    EHashMap(const EHashMap &) = delete;
+    EHashMap &operator = (const EHashMap &) = delete;
+
+    ~EHashMap()
+    {
+        clear();
+        if(m_slots)
+            efree(m_slots);
+    }
+
+    size_t size()        const { return m_size;     }
+    bool   empty()       const { return !m_size;    }
+    size_t getCapacity() const { return m_capacity; }
+
+    //
+    // Make room for at least count entries without further rehashing.
+    //
+    void reserve(size_t count)
+    {
+        const size_t capacity = CapacityFor(count);
+        if(capacity > m_capacity)
+            rehash(capacity);
+    }
+
+    //
+    // Destroy all entries. The slot array is kept for reuse.
+    //
+    void clear()
+    {
+        for(size_t i = 0; i < m_capacity && m_size; i++)
+        {
+            if(m_slots[i].dist)
+            {
+                m_slots[i].entry().~value_type();
+                m_slots[i].dist = 0;
+                --m_size;
+            }
+        }
+    }
+
+    //
+    // Returns a pointer to the value for key, or nullptr if it is not present.
+    //
+    template<typename L>
+    V *find(const L &key)
+    {
+        const lookup_t<L> &lk = key;
+        slot_t *const slot = findSlot(lk, m_hasher(lk));
+        return slot ? &slot->entry().second : nullptr;
+    }
+
+    template<typename L>
+    const V *find(const L &key) const { return const_cast<EHashMap *>(this)->find(key); }
+
+    template<typename L>
+    bool contains(const L &key) const { return find(key) != nullptr; }
+
+    //
+    // Insert a value constructed from args under key, if the key is not already
+    // present. Returns the value for key, and whether it was inserted.
+    //
+    template<typename L, typename... Args>
+    std::pair<V *, bool> emplace(L &&key, Args &&...args)
+    {
+        const lookup_t<L> &lk   = key;
+        const size_t       hash = m_hasher(lk);
+
+        if(slot_t *const slot = findSlot(lk, hash))
+            return { &slot->entry().second, false };
+
+        if((m_size + 1) * 5 > m_capacity * 4)
+            rehash(m_capacity ? m_capacity * 2 : MIN_CAPACITY);
+
+        value_type *const entry = 
+            insertNew(hash, value_type(std::piecewise_construct,
+                                       std::forward_as_tuple(std::forward<L>(key)),
+                                       std::forward_as_tuple(std::forward<Args>(args)...)));
+        return { &entry->second, true };
+    }
+
+    //
+    // Set the value for key, replacing any existing value.
+    //
+    template<typename L, typename T>
+    V &set(L &&key, T &&value)
+    {
+        auto res = emplace(std::forward<L>(key), std::forward<T>(value));
+        if(!res.second)
+            *res.first = std::forward<T>(value);
+        return *res.first;
+    }
+
+    //
+    // Returns the value for key, default-constructing it if not present.
+    //
+    template<typename L>
+    V &operator [] (L &&key) { return *emplace(std::forward<L>(key)).first; }
+
+    //
+    // Remove the entry for key. Returns false if it was not present.
+    //
+    template<typename L>
+    bool erase(const L &key)
+    {
+        const lookup_t<L> &lk   = key;
+        slot_t            *slot = findSlot(lk, m_hasher(lk));
+
+        if(!slot)
+            return false;
+
+        slot->entry().~value_type();
+        slot->dist = 0;
+        --m_size;
+
+        // Shift the following entries back by one until reaching an empty slot
+        // or one already in its home position.
+        const size_t mask = m_capacity - 1;
+        size_t       idx  = size_t(slot - m_slots);
+
+        for(;;)
+        {
+            const size_t next  = (idx + 1) & mask;
+            slot_t      &nslot = m_slots[next];
+
+            if(nslot.dist <= 1)
+                break;
+
+            ::new(m_slots[idx].storage) value_type(std::move(nslot.entry()));
+            m_slots[idx].dist = nslot.dist - 1;
+            m_slots[idx].hash = nslot.hash;
+            nslot.entry().~value_type();
+            nslot.dist = 0;
+            idx = next;
+        }
+
+        return true;
+    }
+
+    void swapWith(EHashMap &other) noexcept
+    {
+        std::swap(m_slots,    other.m_slots);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size,     other.m_size);
+        std::swap(m_shift,    other.m_shift);
+        std::swap(m_hasher,   other.m_hasher);
+        std::swap(m_equal,    other.m_equal);
+    }
+
+    iterator       begin()       { return iterator(m_slots, m_slots + m_capacity);       }
+    iterator       end()         { return iterator(m_slots + m_capacity, m_slots + m_capacity); }
+    const_iterator begin() const { return const_iterator(m_slots, m_slots + m_capacity); }
+    const_iterator end()   const { return const_iterator(m_slots + m_capacity, m_slots + m_capacity); }
+};
+
+// Map keyed by qstring, considering case; searchable by C string or string view.
+template<typename V>
+using EQStrHashMap = EHashMap<qstring, V, qstring::charcasehash, qstring::charcaseequal>;
+
+// Map keyed by qstring, ignoring case; searchable by C string or string view.
+template<typename V>
+using EQStrNoCaseHashMap = EHashMap<qstring, V, qstring::charhash, qstring::charequal>;
+
+// EOF
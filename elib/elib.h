@@ -69,6 +69,7 @@
 
 // Memory handling
 #include "zone.h"
+#include "pool.h"
 
 #if defined(__cplusplus)
 // Smart pointer types
@@ -128,6 +129,15 @@ typedef uint32_t euint;
 #define ELIB_IS_X64 1
 #endif
 
+//
+// Is big-endian processor?
+// Add your own processor define here if it's not covered.
+//
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__) || \
+    defined(__BIG_ENDIAN__) || defined(_BIG_ENDIAN)
+#define ELIB_BIG_ENDIAN 1
+#endif
+
 //
 // Some platforms may not allow an application to exit on its own
 //
@@ -0,0 +1,145 @@
+/*
+  ELib
+
+  Read-only memory-mapped files
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <utility>
+
+#include "elib.h"
+#include "../hal/hal_platform.h"
+#include "mappedfile.h"
+#include "misc.h"
+
+EMappedFile::EMappedFile(EMappedFile &&other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_open(std::exchange(other.m_open, false)),
+      m_mapped(std::exchange(other.m_mapped, false))
+{
+}
+
+EMappedFile &EMappedFile::operator = (EMappedFile &&other) noexcept
+{
+    if(this != &other)
+    {
+        close();
+        m_data   = std::exchange(other.m_data, nullptr);
+        m_size   = std::exchange(other.m_size, 0);
+        m_open   = std::exchange(other.m_open, false);
+        m_mapped = std::exchange(other.m_mapped, false);
+    }
+    return *this;
+}
+
+//
+// Open a file, replacing any file already held. A mapping that cannot promise
+// a terminating zero is dropped in favor of reading when MF_TERMINATED is set.
+// Empty files cannot be mapped, so they always take the read path.
+//
+bool EMappedFile::open(const char *path, unsigned int flags)
+{
+    close();
+
+    if(hal_platform.mapFile)
+    {
+        size_t   size       = 0;
+        hal_bool terminated = HAL_FALSE;
+
+        if(const void *const data = hal_platform.mapFile(path, &size, &terminated); data)
+        {
+            if(terminated || !(flags & MF_TERMINATED))
+            {
+                m_data   = static_cast<const ebyte *>(data);
+                m_size   = size;
+                m_open   = true;
+                m_mapped = true;
+                return true;
+            }
+            hal_platform.unmapFile(data, size);
+        }
+    }
+
+    if(flags & MF_NOFALLBACK)
+        return false;
+
+    return readIn(path);
+}
+
+//
+// Read the whole file into an allocation, which is always terminated. Only
+// the terminator is written beyond what the read supplies.
+//
+bool EMappedFile::readIn(const char *path)
+{
+    FILE *const f = hal_platform.fileOpen(path, "rb");
+    if(!f)
+        return false;
+
+    const long length = M_FileLength(f);
+    if(length < 0)
+    {
+        std::fclose(f);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(length);
+    ebyte *const data = emalloc(ebyte, size + 1);
+
+    const size_t got = std::fread(data, 1, size, f);
+    std::fclose(f);
+
+    if(got != size)
+    {
+        efree(data);
+        return false;
+    }
+    data[size] = 0;
+
+    m_data = data;
+    m_size = size;
+    m_open = true;
+    return true;
+}
+
+//
+// Release the contents; any view obtained from the file becomes invalid.
+//
+void EMappedFile::close()
+{
+    if(m_data)
+    {
+        if(m_mapped)
+            hal_platform.unmapFile(m_data, m_size);
+        else
+            efree(const_cast<ebyte *>(m_data));
+    }
+    m_data   = nullptr;
+    m_size   = 0;
+    m_open   = false;
+    m_mapped = false;
+}
+
+// EOF
@@ -0,0 +1,85 @@
+/*
+  ELib
+
+  Read-only memory-mapped files
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <string_view>
+
+#include "elib.h"
+
+//
+// Read-only view of a whole file's contents. The file is memory-mapped through
+// hal_platform where the platform supports it, so that its contents can be
+// consumed without copying; otherwise, unless MF_NOFALLBACK is given, the file
+// is read into an allocated buffer instead.
+//
+class EMappedFile
+{
+public:
+    enum flags_e
+    {
+        MF_DEFAULT    = 0,
+        MF_TERMINATED = 0x00000001, // a zero byte must follow the data
+        MF_NOFALLBACK = 0x00000002  // fail rather than read the file into memory
+    };
+
+    EMappedFile() = default;
+    explicit EMappedFile(const char *path, unsigned int flags = MF_DEFAULT) { open(path, flags); }
+    ~EMappedFile() { close(); }
+
+    EMappedFile(EMappedFile &&other) noexcept;
+    EMappedFile &operator = (EMappedFile &&other) noexcept;
+
+    // non-copyable
+    EMappedFile(const EMappedFile &) = delete;
+    EMappedFile &operator = (const EMappedFile &) = delete;
+
+    bool open(const char *path, unsigned int flags = MF_DEFAULT);
+    void close();
+
+    bool isOpen()   const { return m_open;   }
+    bool isMapped() const { return m_mapped; }
+
+    const ebyte *getData() const { return m_data; }
+    size_t       getSize() const { return m_size; }
+
+    // With MF_TERMINATED the contents are also a valid C string.
+    const char *getChars() const { return reinterpret_cast<const char *>(m_data); }
+
+    std::string_view getView() const { return { getChars(), m_size }; }
+
+private:
+    const ebyte *m_data   = nullptr;
+    size_t       m_size   = 0;
+    bool         m_open   = false;
+    bool         m_mapped = false; // m_data is a mapping rather than an allocation
+
+    bool readIn(const char *path);
+};
+
+// EOF
@@ -83,7 +83,7 @@ size_t M_ReadFile(const char *name, ebyte **buffer)
    {
       const size_t length = static_cast<size_t>(M_FileLength(fp));
 
-      *buffer = ecalloc(uint8_t, 1, length);
+      *buffer = emalloc(uint8_t, length);
 
       if(std::fread(*buffer, 1, length, fp) == length)
       {
@@ -120,9 +120,11 @@ char *M_LoadStringFromFile(const char *filename)
     {
         // allocate at length+1 for null termination
         const size_t len = static_cast<size_t>(M_FileLength(f));
-        buf = ecalloc(char, 1, len + 1);
-        if(std::fread(buf, 1, len, f) != len)
+        buf = emalloc(char, len + 1);
+        const size_t got = std::fread(buf, 1, len, f);
+        if(got != len)
             hal_platform.debugMsg("Warning: short read of file %s\n", filename);
+        buf[got] = '\0';
         std::fclose(f);
     }
 
@@ -211,65 +213,207 @@ char *M_Itoa(int value, char *string, int radix)
 
 //=============================================================================
 //
-// Case-Insensitive Substring Search
+// Case-Insensitive Comparison, Search, and Hashing
+//
+// These fold ASCII letters only, matching ectype::toLower in the C locale.
+// Blocks of 16 bytes are folded at once with SSE2 where available, and 8 at
+// a time in a general-purpose register otherwise.
 //
 
-/*-
- * Copyright (c) 1990, 1993
- *	The Regents of the University of California.  All rights reserved.
- *
- * This code is derived from software contributed to Berkeley by
- * Chris Torek.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in the
- *    documentation and/or other materials provided with the distribution.
- * 3. Neither the name of the University nor the names of its contributors
- *    may be used to endorse or promote products derived from this software
- *    without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
- * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
- * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
- * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
- * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
- * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
- * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
- * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
- * SUCH DAMAGE.
- */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ELIB_MISC_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static constexpr uint64_t MISC_ONES = 0x0101010101010101ull;
 
 //
-// Find the first occurrence of find in s, ignore case.
+// Load 8 bytes without alignment requirements.
 //
-const char *M_StrCaseStr(const char *s, const char *find)
+static inline uint64_t MiscRead64(const void *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//
+// Load 4 bytes without alignment requirements.
+//
+static inline uint32_t MiscRead32(const void *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//
+// Fold the uppercase ASCII letters in a word of 8 bytes to lowercase.
+//
+static inline uint64_t MiscFold64(uint64_t x)
+{
+    const uint64_t low7  = x & (0x7f * MISC_ONES);
+    const uint64_t geA   = low7 + ((0x80 - 'A') * MISC_ONES);     // high bit set if >= 'A'
+    const uint64_t gtZ   = low7 + ((0x80 - 'Z' - 1) * MISC_ONES); // high bit set if > 'Z'
+    const uint64_t upper = (geA ^ gtZ) & ~x & (0x80 * MISC_ONES);
+
+    return x | (upper >> 2);
+}
+
+//
+// Fold a single character the same way.
+//
+static inline unsigned char MiscFold8(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c | 0x20 : c;
+}
+
+#if defined(ELIB_MISC_SSE2)
+//
+// Index of the lowest set bit in a non-zero mask.
+//
+static inline unsigned int MiscCountTrailingZeros(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return idx;
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+//
+// Fold the uppercase ASCII letters in a 16-byte vector to lowercase.
+//
+static inline __m128i MiscFold128(__m128i x)
+{
+    // Shift 'A'..'Z' down to the bottom of the signed range, so that a single
+    // signed compare selects them.
+    const __m128i shifted = _mm_add_epi8(x, _mm_set1_epi8(char(0x80 - 'A')));
+    const __m128i upper   = _mm_cmplt_epi8(shifted, _mm_set1_epi8(char(0x80 + 26)));
+
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+//
+// Compare n bytes of two buffers, ignoring ASCII case. The result has the
+// same sign as strncasecmp would give for strings without embedded nulls.
+//
+int M_MemCaseCmp(const char *s1, const char *s2, size_t n)
 {
-    char c, sc;
+    auto a = reinterpret_cast<const unsigned char *>(s1);
+    auto b = reinterpret_cast<const unsigned char *>(s2);
 
-    if((c = *find++) != 0)
+#if defined(ELIB_MISC_SSE2)
+    while(n >= 16)
     {
-        c = ectype::toLower(c);
-        const size_t len = strlen(find);
-        do 
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+
+        // Most compared strings agree in case as well, so try the exact match
+        // before paying for the fold.
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff)
         {
-            do
+            const __m128i fa = MiscFold128(va);
+            const __m128i fb = MiscFold128(vb);
+            const unsigned int diff = ~unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(fa, fb))) & 0xffff;
+
+            if(diff)
             {
-                if((sc = *s++) == 0)
-                    return nullptr;
+                const unsigned int i = MiscCountTrailingZeros(diff);
+                return int(MiscFold8(a[i])) - int(MiscFold8(b[i]));
             }
-            while(static_cast<char>(ectype::toLower(sc)) != c);
         }
-        while(strncasecmp(s, find, len) != 0);
-        s--;
+        a += 16;
+        b += 16;
+        n -= 16;
     }
-    return s;
+#endif
+
+    while(n >= 8)
+    {
+        if(MiscFold64(MiscRead64(a)) != MiscFold64(MiscRead64(b)))
+            break; // resolve in the byte loop below
+        a += 8;
+        b += 8;
+        n -= 8;
+    }
+
+    while(n--)
+    {
+        const int ca = MiscFold8(*a++);
+        const int cb = MiscFold8(*b++);
+        if(ca != cb)
+            return ca - cb;
+    }
+
+    return 0;
+}
+
+//
+// Find the first occurrence of needle in haystack, ignoring ASCII case. Both
+// are given with explicit lengths. Returns nullptr if there is no match.
+//
+const char *M_MemCaseMem(const char *haystack, size_t hlen, const char *needle, size_t nlen)
+{
+    if(nlen == 0)
+        return haystack;
+    if(nlen > hlen)
+        return nullptr;
+
+    const unsigned char first = MiscFold8(static_cast<unsigned char>(needle[0]));
+    const size_t        last  = hlen - nlen; // last valid starting position
+    size_t              i     = 0;
+
+#if defined(ELIB_MISC_SSE2)
+    // Test 16 candidate positions at once against the needle's first and last
+    // characters, and only verify the positions where both match.
+    const __m128i vfirst = _mm_set1_epi8(char(first));
+    const __m128i vlast  = _mm_set1_epi8(char(MiscFold8(static_cast<unsigned char>(needle[nlen - 1]))));
+
+    for(; i + 16 <= last + 1; i += 16)
+    {
+        const __m128i blockFirst = 
+            MiscFold128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i)));
+        const __m128i blockLast  = 
+            MiscFold128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + nlen - 1)));
+
+        unsigned int mask = unsigned(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, vfirst),
+                                                                     _mm_cmpeq_epi8(blockLast,  vlast))));
+        while(mask)
+        {
+            const size_t pos = i + MiscCountTrailingZeros(mask);
+            if(!M_MemCaseCmp(haystack + pos + 1, needle + 1, nlen - 1))
+                return haystack + pos;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for(; i <= last; i++)
+    {
+        if(MiscFold8(static_cast<unsigned char>(haystack[i])) == first &&
+           !M_MemCaseCmp(haystack + i + 1, needle + 1, nlen - 1))
+        {
+            return haystack + i;
+        }
+    }
+
+    return nullptr;
+}
+
+//
+// Find the first occurrence of find in s, ignore case.
+//
+const char *M_StrCaseStr(const char *s, const char *find)
+{
+    return M_MemCaseMem(s, std::strlen(s), find, std::strlen(find));
 }
 
 //
@@ -280,6 +424,113 @@ char *M_StrCaseStrMutable(char *s, const char *find)
     return const_cast<char *>(M_StrCaseStr(s, find));
 }
 
+//
+// 64x64->128 bit multiply, returning the two halves xor'd together.
+//
+static inline uint64_t MiscMum(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t hi;
+    const uint64_t lo = _umul128(a, b, &hi);
+    return lo ^ hi;
+#else
+    const uint64_t ha = a >> 32, la = uint32_t(a);
+    const uint64_t hb = b >> 32, lb = uint32_t(b);
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t  = rl + (rm0 << 32);
+    const uint64_t lo = t + (rm1 << 32);
+    const uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    return lo ^ hi;
+#endif
+}
+
+static constexpr uint64_t MISC_HASHK0 = 0xa0761d6478bd642full;
+static constexpr uint64_t MISC_HASHK1 = 0xe7037ed1a0b428dbull;
+static constexpr uint64_t MISC_HASHK2 = 0x8ebc6af09c88c6e3ull;
+
+//
+// Multiply-mix hash in the style of wyhash, consuming 16 bytes per round.
+// When nocase is set, each block is case-folded before it is mixed, so that
+// strings differing only in ASCII case hash identically.
+//
+template<bool nocase>
+static uint64_t MiscHash(const unsigned char *p, size_t len)
+{
+    uint64_t seed = MISC_HASHK0 ^ MiscMum(len ^ MISC_HASHK1, MISC_HASHK0);
+    uint64_t a, b;
+    size_t   n = len;
+
+    while(n > 16)
+    {
+#if defined(ELIB_MISC_SSE2)
+        if constexpr(nocase)
+        {
+            const __m128i v = MiscFold128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+            alignas(16) uint64_t words[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(words), v);
+            a = words[0];
+            b = words[1];
+        }
+        else
+#endif
+        {
+            a = MiscRead64(p);
+            b = MiscRead64(p + 8);
+            if constexpr(nocase)
+            {
+                a = MiscFold64(a);
+                b = MiscFold64(b);
+            }
+        }
+        seed = MiscMum(a ^ MISC_HASHK1, b ^ seed);
+        p += 16;
+        n -= 16;
+    }
+
+    // Final 0 to 16 bytes, read as overlapping words so that no byte outside
+    // the buffer is touched
+    if(n >= 4)
+    {
+        const size_t step = (n >> 3) << 2; // n is 4 to 16: 0 below 8, 4 below 16, 8 at 16
+        a = (uint64_t(MiscRead32(p)) << 32)         | MiscRead32(p + step);
+        b = (uint64_t(MiscRead32(p + n - 4)) << 32) | MiscRead32(p + n - 4 - step);
+    }
+    else if(n > 0)
+    {
+        a = (uint64_t(p[0]) << 16) | (uint64_t(p[n >> 1]) << 8) | p[n - 1];
+        b = 0;
+    }
+    else
+        a = b = 0;
+
+    if constexpr(nocase)
+    {
+        a = MiscFold64(a);
+        b = MiscFold64(b);
+    }
+
+    return MiscMum(MISC_HASHK2 ^ len, MiscMum(a ^ MISC_HASHK1, b ^ seed));
+}
+
+//
+// Hash a buffer of bytes.
+//
+uint64_t M_HashBytes(const void *data, size_t len)
+{
+    return MiscHash<false>(static_cast<const unsigned char *>(data), len);
+}
+
+//
+// Hash a buffer of bytes, ignoring ASCII case.
+//
+uint64_t M_HashBytesNoCase(const void *data, size_t len)
+{
+    return MiscHash<true>(static_cast<const unsigned char *>(data), len);
+}
+
 //=============================================================================
 //
 // BSD-Style String Utilities
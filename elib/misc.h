@@ -65,6 +65,19 @@ const char *M_StrCaseStr(const char *s, const char *find);
 // Version of M_StrCaseStr for mutable strings
 char       *M_StrCaseStrMutable(char *s, const char *find);
 
+//
+// Case-Insensitive Comparison and Hashing
+//
+
+// Compare n bytes of two buffers, ignoring ASCII case.
+int         M_MemCaseCmp(const char *s1, const char *s2, size_t n);
+// Find the first occurrence of needle in haystack, ignoring ASCII case.
+const char *M_MemCaseMem(const char *haystack, size_t hlen, const char *needle, size_t nlen);
+// Hash a buffer of bytes
+uint64_t    M_HashBytes(const void *data, size_t len);
+// Hash a buffer of bytes, ignoring ASCII case
+uint64_t    M_HashBytesNoCase(const void *data, size_t len);
+
 //
 // BSD-like String Utilities
 //
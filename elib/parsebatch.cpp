@@ -0,0 +1,75 @@
+/*
+  ELib
+
+  Concurrent parsing of independent files
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <atomic>
+#include <thread>
+
+#include "elib.h"
+#include "parsebatch.h"
+
+//
+// Parse every file of the batch, then merge the results in input order.
+//
+void EParseBatch::run(unsigned int maxThreads)
+{
+   std::vector<std::unique_ptr<EParser>> parsers;
+   parsers.reserve(m_files.size());
+   for(const qstring &file : m_files)
+   {
+      if(std::unique_ptr<EParser> parser = m_factory(file.c_str()); parser)
+         parsers.push_back(std::move(parser));
+   }
+
+   const size_t count = parsers.size();
+   if(!count)
+      return;
+
+   const size_t wanted     = maxThreads ? maxThreads : std::thread::hardware_concurrency();
+   const size_t numThreads = eclamp<size_t>(wanted, 1, count);
+
+   // Files are handed out one at a time, so a large file does not hold up a
+   // whole share of the rest.
+   std::atomic<size_t> next { 0 };
+   const auto worker = [&parsers, &next, count] {
+      for(size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count; )
+         parsers[i]->parseFile();
+   };
+
+   std::vector<std::thread> pool;
+   pool.reserve(numThreads - 1);
+   for(size_t i = 1; i < numThreads; i++)
+      pool.emplace_back(worker);
+   worker();
+   for(std::thread &thread : pool)
+      thread.join();
+
+   for(const std::unique_ptr<EParser> &parser : parsers)
+      parser->mergeResults();
+}
+
+// EOF
@@ -0,0 +1,69 @@
+/*
+  ELib
+
+  Concurrent parsing of independent files
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "elib.h"
+#include "parser.h"
+#include "qstring.h"
+
+//
+// Parses a set of independent files concurrently. A parser is made for each
+// file by the factory, and the files are loaded, tokenized and parsed on a
+// pool of worker threads. Parsers must therefore keep what they find to
+// themselves until mergeResults is called, which happens on the calling
+// thread for each parser in turn, in the order the files were added, so the
+// merged outcome does not depend on scheduling.
+//
+class EParseBatch
+{
+public:
+   // May return nullptr to skip a file.
+   using factory_t = std::function<std::unique_ptr<EParser> (const char *filename)>;
+
+   explicit EParseBatch(factory_t factory)
+      : m_factory(std::move(factory))
+   {
+   }
+
+   void addFile(const char *filename) { m_files.emplace_back(filename); }
+
+   // Parse all added files with up to maxThreads threads, including the
+   // calling thread; 0 uses one per hardware thread.
+   void run(unsigned int maxThreads = 0);
+
+protected:
+   factory_t            m_factory;
+   std::vector<qstring> m_files;
+};
+
+// EOF
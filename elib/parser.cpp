@@ -26,204 +26,411 @@
   SOFTWARE.
 */
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "elib.h"
+#include "../hal/hal_platform.h"
+#include "mappedfile.h"
 #include "misc.h"
 #include "parser.h"
 
 //=============================================================================
 //
-// Tokenizer
+// Streaming Input
 //
-// Does proper FSA tokenization
+
 //
+// The chunk ring shared with the reader thread. It is kept out of the header
+// so that includers of parser.h do not pull in the threading headers.
+//
+struct EFileTokenSource::ring_t
+{
+   struct chunk_t
+   {
+      char  *data;
+      size_t length;
+   };
+
+   FILE                   *file;
+   chunk_t                 chunks[NUM_CHUNKS];
+   size_t                  head   = 0;     // next chunk to consume
+   size_t                  tail   = 0;     // next chunk to fill
+   size_t                  filled = 0;     // chunks ready to consume
+   size_t                  offset = 0;     // position in the head chunk
+   bool                    eof    = false; // reader has finished
+   bool                    stop   = false; // reader should exit
+   std::mutex              lock;
+   std::condition_variable cv;
+   std::thread             reader;
+
+   void readerThread();
+};
 
 //
-// State Handlers
+// Allocate the chunk ring and start reading.
 //
+EFileTokenSource::EFileTokenSource(FILE *file)
+   : m_ring(std::make_unique<ring_t>())
+{
+   m_ring->file = file;
+   for(ring_t::chunk_t &chunk : m_ring->chunks)
+   {
+      chunk.data   = emalloc(char, CHUNK_SIZE);
+      chunk.length = 0;
+   }
 
-// Looking for the start of a new token
-void ETokenizer::doStateScan()
+   m_ring->reader = std::thread(&ring_t::readerThread, m_ring.get());
+}
+
+//
+// Stop the reader and release the ring.
+//
+EFileTokenSource::~EFileTokenSource()
 {
-   const char c = m_input[m_idx];
+   {
+      std::lock_guard lock(m_ring->lock);
+      m_ring->stop = true;
+   }
+   m_ring->cv.notify_all();
+   m_ring->reader.join();
+
+   for(ring_t::chunk_t &chunk : m_ring->chunks)
+      efree(chunk.data);
+}
 
-   switch(c)
+//
+// Background thread body: fill free chunks in order until the file ends.
+//
+void EFileTokenSource::ring_t::readerThread()
+{
+   for(;;)
    {
-   case ' ':
-   case '\t':
-   case '\r':
-      // remain in this state
-      break;
-   case '\n':
-      // if linebreaks are tokens, return one now
-      if(m_flags & TF_LINEBREAKS)
+      chunk_t *chunk;
       {
-         m_tokentype = TOKEN_LINEBREAK;
-         m_state     = STATE_DONE;
+         std::unique_lock guard(lock);
+         cv.wait(guard, [this] { return stop || filled < NUM_CHUNKS; });
+         if(stop)
+            return;
+         chunk = &chunks[tail];
       }
-      // otherwise, remain in this state
-      break;
-   case '\0': // end of input
-      m_tokentype = TOKEN_EOF;
-      m_state     = STATE_DONE;
-      break;
-   case '"': // start of a quoted string
-      m_tokentype = TOKEN_STRING;
-      m_state     = STATE_QUOTED;
-      break;
-   default:
-      if(c == '/' && m_input[m_idx + 1] == '/')
-      {
-         // start of a single-line comment
-         m_state = STATE_COMMENT;
-         break;
-      }
-      else if(c == '[' && (m_flags & TF_BRACKETS))
+
+      // the chunk is not visible to the consumer until published below
+      const size_t got = std::fread(chunk->data, 1, CHUNK_SIZE, file);
+
       {
-         // start of bracket string
-         m_tokentype = TOKEN_BRACKETSTR;
-         m_state     = STATE_INBRACKETS;
-         break;
+         std::lock_guard guard(lock);
+         if(got)
+         {
+            chunk->length = got;
+            tail = (tail + 1) % NUM_CHUNKS;
+            ++filled;
+         }
+         if(got < CHUNK_SIZE) // end of file, or a read error
+            eof = true;
       }
-      else if(c == '$')
-         m_tokentype = TOKEN_KEYWORD; // $ keyword
-      else
-         m_tokentype = TOKEN_STRING;  // anything else is a string
+      cv.notify_all();
 
-      m_state = STATE_INTOKEN;
-      m_token += c;
-      break;
+      if(got < CHUNK_SIZE)
+         return;
    }
 }
 
-// Scanning inside a token
-void ETokenizer::doStateInToken()
+//
+// Copy out whatever has been read so far, waiting only if nothing is ready.
+//
+size_t EFileTokenSource::read(char *dst, size_t size)
 {
-   const char c = m_input[m_idx];
+   ring_t &ring = *m_ring;
 
-   switch(c)
+   std::unique_lock lock(ring.lock);
+   size_t total = 0;
+
+   while(total < size)
    {
-   case '\n':
-      if(m_flags & TF_LINEBREAKS) // if linebreaks are tokens, need to back up
-         --m_idx;
-      // fall through
-   case ' ': // whitespace
-   case '\t':
-   case '\r':
-      // end of token
-      m_state = STATE_DONE;
-      break;
-   case '\0': // end of input
-      --m_idx; // backup; next call will handle it in STATE_SCAN
-      m_state = STATE_DONE;
-      break;
-   default:
-      if(c == '/' && m_input[m_idx + 1] == '/')
+      if(!ring.filled)
       {
-         // start of comment
-         --m_idx;
-         m_state = STATE_DONE;
-         break;
+         if(total || ring.eof)
+            break;
+         ring.cv.wait(lock, [&ring] { return ring.filled || ring.eof; });
+         continue;
+      }
+
+      ring_t::chunk_t &chunk = ring.chunks[ring.head];
+      const size_t     n     = emin(size - total, chunk.length - ring.offset);
+
+      std::memcpy(dst + total, chunk.data + ring.offset, n);
+      total       += n;
+      ring.offset += n;
+
+      if(ring.offset == chunk.length)
+      {
+         // hand the chunk back to the reader
+         ring.offset = 0;
+         ring.head   = (ring.head + 1) % NUM_CHUNKS;
+         --ring.filled;
+         ring.cv.notify_all();
       }
-      m_token += c;
-      break;
    }
+
+   return total;
 }
 
-// Reading out a bracketed string token
-void ETokenizer::doStateInBrackets()
+//=============================================================================
+//
+// Tokenizer
+//
+// Scans each token in a single pass driven by a character class table.
+// Quoted strings, bracketed strings, and comments are skipped to their end
+// with strchr, which the C library vectorizes.
+//
+
+// Character classes
+enum tokencc_e : unsigned char
 {
-   switch(m_input[m_idx])
-   {
-   case ']': // end of bracketed token
-      m_state = STATE_DONE;
-      break;
-   case '\0': // end of input (technically, malformed)
-      --m_idx;
-      m_state = STATE_DONE;
-      break;
-   default:
-      m_token += m_input[m_idx];
-      break;
-   }
+   CC_SPACE   = 0x01, // ' ', '\t', '\r'
+   CC_NEWLINE = 0x02, // '\n'
+   CC_NUL     = 0x04, // end of input
+   CC_SLASH   = 0x08, // possible start of a comment
+
+   // characters which end an unquoted token
+   CC_TOKENSTOP = CC_SPACE | CC_NEWLINE | CC_NUL | CC_SLASH
+};
+
+struct tokencc_t
+{
+   unsigned char cls[256];
+};
+
+static constexpr tokencc_t TokenBuildClasses()
+{
+   tokencc_t cc {};
+
+   cc.cls[unsigned(' ')]  = CC_SPACE;
+   cc.cls[unsigned('\t')] = CC_SPACE;
+   cc.cls[unsigned('\r')] = CC_SPACE;
+   cc.cls[unsigned('\n')] = CC_NEWLINE;
+   cc.cls[0]              = CC_NUL;
+   cc.cls[unsigned('/')]  = CC_SLASH;
+
+   return cc;
 }
 
-// Reading out a quoted string token
-void ETokenizer::doStateQuoted()
+static constexpr tokencc_t tokencc = TokenBuildClasses();
+
+static inline unsigned char TokenClass(char c)
 {
-   switch(m_input[m_idx])
-   {
-   case '"': // end of quoted string
-      m_state = STATE_DONE;
-      break;
-   case '\0': // end of input (technically, malformed)
-      --m_idx;
-      m_state = STATE_DONE;
-      break;
-   default:
-      m_token += m_input[m_idx];
-      break;
-   }
+   return tokencc.cls[static_cast<unsigned char>(c)];
 }
 
-// Reading out a single-line comment
-void ETokenizer::doStateComment()
+//
+// Find the closing delimiter of a quoted or bracketed string, or the end of
+// input if it is missing.
+//
+static const char *TokenFindClose(const char *p, char delim)
 {
-   // consume all input to the end of the line
-   if(m_input[m_idx] == '\n')
+   const char *const close = std::strchr(p, delim);
+   return close ? close : p + std::strlen(p);
+}
+
+//
+// Scan one token starting from the current position in the loaded input.
+//
+void ETokenizer::scanToken()
+{
+   const bool     linebreaks = (m_flags & TF_LINEBREAKS) != 0;
+   const unsigned skipMask   = CC_SPACE | (linebreaks ? 0 : CC_NEWLINE);
+   const char    *p          = m_input + m_idx;
+
+   m_tokentype = TOKEN_NONE; // nothing has been determined yet
+
+   // finish a comment left open at the end of the previous window
+   if(m_inComment)
    {
-      // if linebreak tokens are enabled, send one now
-      if(m_flags & TF_LINEBREAKS)
+      if(const char *const nl = std::strchr(p, '\n'); nl)
       {
-         m_tokentype = TOKEN_LINEBREAK;
-         m_state     = STATE_DONE;
+         p = linebreaks ? nl : nl + 1;
+         m_inComment = false;
       }
       else
-         m_state = STATE_SCAN;
+         p += std::strlen(p);
    }
-   else if(m_input[m_idx] == '\0') // end of input
+
+   for(;;)
    {
-      m_tokentype = TOKEN_EOF;
-      m_state     = STATE_DONE;
+      // skip whitespace between tokens
+      while(TokenClass(*p) & skipMask)
+         ++p;
+
+      // nothing before here is needed again if the input must be refilled
+      m_scanFrom = int(p - m_input);
+
+      const char c = *p;
+
+      if(c == '\0')
+      {
+         // end of input; stays put so that further calls also return EOF
+         m_tokentype = TOKEN_EOF;
+         m_tokenStart = m_tokenEnd = int(p - m_input);
+         break;
+      }
+      else if(c == '\n')
+      {
+         // only reached when linebreaks are tokens
+         m_tokentype = TOKEN_LINEBREAK;
+         m_tokenStart = m_tokenEnd = int(p - m_input);
+         ++p;
+         break;
+      }
+      else if(c == '/' && p[1] == '/')
+      {
+         // single-line comment; eat the rest of the line
+         const char *const nl = std::strchr(p + 2, '\n');
+         if(!nl)
+         {
+            m_inComment = true; // a streamed input may continue the line
+            p += std::strlen(p);
+            continue; // EOF handled above
+         }
+         p = nl;
+         if(!linebreaks)
+            ++p;
+         continue; // line break handled above, if it is a token
+      }
+      else if(c == '"')
+      {
+         // quoted string
+         const char *const close = TokenFindClose(p + 1, '"');
+         m_tokentype  = TOKEN_STRING;
+         m_tokenStart = int(p + 1 - m_input);
+         m_tokenEnd   = int(close - m_input);
+         p = *close ? close + 1 : close;
+         break;
+      }
+      else if(c == '[' && (m_flags & TF_BRACKETS))
+      {
+         // bracketed string
+         const char *const close = TokenFindClose(p + 1, ']');
+         m_tokentype  = TOKEN_BRACKETSTR;
+         m_tokenStart = int(p + 1 - m_input);
+         m_tokenEnd   = int(close - m_input);
+         p = *close ? close + 1 : close;
+         break;
+      }
+
+      // anything else starts a keyword or plain string, which runs until
+      // whitespace, end of input, or a comment
+      m_tokentype  = (c == '$') ? TOKEN_KEYWORD : TOKEN_STRING;
+      m_tokenStart = int(p - m_input);
+
+      const char *q = p + 1;
+      for(;;)
+      {
+         while(!(TokenClass(*q) & CC_TOKENSTOP))
+            ++q;
+         if(*q == '/' && q[1] != '/')
+         {
+            ++q; // a lone slash is part of the token
+            continue;
+         }
+         break;
+      }
+
+      m_tokenEnd = int(q - m_input);
+
+      // consume a terminating space, and a terminating linebreak unless it
+      // must be returned as the next token
+      if((TokenClass(*q) & CC_SPACE) || (*q == '\n' && !linebreaks))
+         ++q;
+      p = q;
+      break;
    }
-}
 
-// State table for the tokenizer
-void (ETokenizer::* ETokenizer::States[])() =
-{
-   &ETokenizer::doStateScan,
-   &ETokenizer::doStateInToken,
-   &ETokenizer::doStateInBrackets,
-   &ETokenizer::doStateQuoted,
-   &ETokenizer::doStateComment
-};
+   m_idx   = int(p - m_input);
+   m_state = STATE_DONE;
+}
 
 //
-// Call this to retrieve the next token from the input string. The token
-// type is returned for convenience. Get the text of the token using the
-// getToken method.
+// Call this to retrieve the next token from the input. The token type is
+// returned for convenience. Get the text of the token using the getTokenView
+// or getToken methods.
 //
 int ETokenizer::getNextToken()
 {
-   m_token.clear();
-   m_state     = STATE_SCAN; // always start out scanning for a new token
-   m_tokentype = TOKEN_NONE; // nothing has been determined yet
+   m_tokenCopied = false;
 
-   // already at end of input?
-   if(m_input[m_idx] != '\0')
+   for(;;)
    {
-      // advance through the input
-      while(m_state != STATE_DONE)
-      {
-         (this->*States[m_state])();
-         ++m_idx;
-      }
+      scanToken();
+
+      // A token which reached the end of a streamed window may continue in
+      // input not yet read. Refill, and scan it again from its start.
+      if(!m_source || m_sourceDone || (m_idx < m_length && m_tokenEnd < m_length))
+         break;
+
+      refill();
    }
-   else
-      m_tokentype = TOKEN_EOF;
 
    return m_tokentype;
 }
 
+//
+// Set up a tokenizer over a streamed input, and load the first window.
+//
+ETokenizer::ETokenizer(ETokenSource &source, size_t windowSize)
+   : m_input(nullptr), m_source(&source), m_capacity(windowSize)
+{
+   m_buffer    = emalloc(char, m_capacity);
+   m_buffer[0] = '\0';
+   m_input     = m_buffer;
+   refill();
+}
+
+//
+// Slide the unconsumed part of the window to the front of the buffer and
+// read more input after it. The buffer only grows when a single token no
+// longer fits.
+//
+void ETokenizer::refill()
+{
+   const int keep = m_length - m_scanFrom;
+
+   if(keep > 0 && m_scanFrom > 0)
+      std::memmove(m_buffer, m_buffer + m_scanFrom, size_t(keep));
+
+   m_length = keep;
+   m_idx    = 0;
+
+   if(size_t(m_length) + 1 >= m_capacity)
+   {
+      m_capacity *= 2;
+      m_buffer    = erealloc(char, m_buffer, m_capacity);
+   }
+
+   const size_t got = m_source->read(m_buffer + m_length, m_capacity - size_t(m_length) - 1);
+   if(!got)
+      m_sourceDone = true;
+
+   m_length += int(got);
+   m_buffer[m_length] = '\0';
+   m_input = m_buffer;
+}
+
+//
+// Returns the text of the current token as a qstring, copying it out of the
+// input on the first call for each token.
+//
+qstring &ETokenizer::getToken()
+{
+   if(!m_tokenCopied)
+   {
+      m_token.clear().concat(getTokenView());
+      m_tokenCopied = true;
+   }
+   return m_token;
+}
+
 //=============================================================================
 //
 // Parser
@@ -231,24 +438,39 @@ int ETokenizer::getNextToken()
 // Base class for simple input script parsing.
 //
 
-// Parse a single file.
+// Parse a single file. The file is streamed through the tokenizer rather than
+// loaded whole, so parsing starts with the first chunk read.
 void EParser::parseFile()
 {
-   // free any previously loaded data
-   if(m_data)
+   // Tokenize straight out of a mapping of the file when one can be had. The
+   // tokenizer needs its input terminated; for the rare file that exactly
+   // fills its pages, the mapping is refused and the file is streamed.
+   if(const EMappedFile map(m_filename, EMappedFile::MF_TERMINATED | EMappedFile::MF_NOFALLBACK); map.isOpen())
    {
-      efree(m_data);
-      m_data = nullptr;
+      ETokenizer tokenizer(map.getChars());
+      parseTokens(tokenizer);
+      return;
    }
 
-   char *file = M_LoadStringFromFile(m_filename);
-   if(estrempty(file))
+   const EAutoFile file(hal_platform.fileOpen(m_filename, "rb"));
+   if(!file)
+      return;
+
+   EFileTokenSource source(file.get());
+   ETokenizer       tokenizer(source);
+   if(tokenizer.emptyInput())
       return; // can't parse an empty file
 
-   m_data = file;
+   parseTokens(tokenizer);
+}
+
+//
+// Run the tokenizer over its whole input, feeding each token to the subclass.
+//
+void EParser::parseTokens(ETokenizer &tokenizer)
+{
    startFile();
 
-   ETokenizer tokenizer(m_data);
    bool early = false;
 
    // allow subclasses to alter properties of the tokenizer now
@@ -28,9 +28,51 @@
 
 #pragma once
 
+#include <memory>
+
 #include "elib.h"
 #include "qstring.h"
 
+//
+// Source of input for a streaming ETokenizer.
+//
+class ETokenSource
+{
+public:
+   virtual ~ETokenSource() {}
+
+   // Copy up to size bytes of input into dst. Returns the number of bytes
+   // copied, which is 0 only at the end of input.
+   virtual size_t read(char *dst, size_t size) = 0;
+};
+
+//
+// Reads a file in fixed-size chunks on a background thread, into a small ring
+// of buffers, so that tokenizing can begin while the rest of the file is still
+// being read. Memory use is bounded by the ring regardless of file size.
+// The file is not closed by this object.
+//
+class EFileTokenSource : public ETokenSource
+{
+public:
+   static constexpr size_t CHUNK_SIZE = 64 * 1024;
+   static constexpr size_t NUM_CHUNKS = 4;
+
+   explicit EFileTokenSource(FILE *file);
+   virtual ~EFileTokenSource();
+
+   // non-copyable
+   EFileTokenSource(const EFileTokenSource &) = delete;
+   EFileTokenSource &operator = (const EFileTokenSource &) = delete;
+
+   virtual size_t read(char *dst, size_t size) override;
+
+protected:
+   struct ring_t; // chunk ring and reader thread, private to parser.cpp
+
+   std::unique_ptr<ring_t> m_ring;
+};
+
 //
 // Tokenizer class used by Parser
 //
@@ -69,21 +111,29 @@ public:
    };
 
 protected:
+   static constexpr size_t DEFAULT_WINDOW = 64 * 1024;
+
    const char *m_input;               // input string
    int m_idx            = 0;          // current position in input string
    int m_state          = STATE_SCAN; // state of the scanner
    int m_tokentype      = TOKEN_NONE; // current token type
-   qstring m_token      { 32 };       // current token value
+   int m_tokenStart     = 0;          // start of current token's text in input
+   int m_tokenEnd       = 0;          // end of current token's text in input
+   qstring m_token      { 32 };       // current token value, once copied
+   bool m_tokenCopied   = false;      // m_token holds the current token
    unsigned int m_flags = TF_DEFAULT; // tokenizer flags
-   
-   void doStateScan();
-   void doStateInToken();
-   void doStateInBrackets();
-   void doStateQuoted();
-   void doStateComment();
+   bool m_inComment     = false;      // a comment is still being skipped
+   int m_scanFrom       = 0;          // earliest position a rescan needs
 
-   // state table declaration
-   static void (ETokenizer::*States[])();
+   // streaming input
+   ETokenSource *m_source = nullptr;      // source of input, if streaming
+   char         *m_buffer = nullptr;      // window into the input
+   size_t        m_capacity = 0;          // allocated size of window
+   int           m_length   = 0;          // bytes of input in window
+   bool          m_sourceDone = false;    // source has no more input
+
+   void scanToken();
+   void refill();
 
 public:
    ETokenizer(const char *str)
@@ -91,10 +141,36 @@ public:
    {
    }
 
+   // Tokenize input drawn from a source through a sliding window, which is
+   // refilled as tokens are consumed. A token may span reads.
+   explicit ETokenizer(ETokenSource &source, size_t windowSize = DEFAULT_WINDOW);
+
+   ~ETokenizer()
+   {
+      if(m_buffer)
+         efree(m_buffer);
+   }
+
+   // non-copyable
+   ETokenizer(const ETokenizer &) = delete;
+   ETokenizer &operator = (const ETokenizer &) = delete;
+
+   // True if a streamed input turned out to be empty
+   bool emptyInput() const { return m_source && m_sourceDone && !m_length; }
+
    int getNextToken();
 
    int getTokenType() const { return m_tokentype; }
-   qstring &getToken() { return m_token; }
+
+   // Tokens have no escape sequences, so a token's text is always a contiguous
+   // run of the input. The view is valid until the input is freed, or for a
+   // streamed input, until the next call to getNextToken.
+   std::string_view getTokenView() const 
+   { 
+      return { m_input + m_tokenStart, size_t(m_tokenEnd - m_tokenStart) };
+   }
+
+   qstring &getToken();
 
    void setTokenFlags(unsigned int flags) { m_flags = flags; }
 };
@@ -107,7 +183,6 @@ class EParser
 {
 protected:
    const char *m_filename; // name of file opened
-   char       *m_data;     // cached lump data
 
    // Called at the beginning of a file
    virtual void startFile() {}
@@ -121,20 +196,21 @@ protected:
    // Called when EOF is reached
    virtual void onEOF(bool early) {}
 
+   // Called on the main thread once every file of an EParseBatch is parsed,
+   // in the order the files were added; see EParseBatch in parsebatch.h.
+   virtual void mergeResults() {}
+
+   void parseTokens(ETokenizer &tokenizer);
+
+   friend class EParseBatch;
+
 public:
    EParser(const char *filename)
-      : m_filename(filename), m_data(nullptr)
+      : m_filename(filename)
    {
    }
 
-   virtual ~EParser()
-   {
-      if(m_data)
-      {
-         efree(m_data);
-         m_data = nullptr;
-      }
-   }
+   virtual ~EParser() {}
 
    void parseFile();
 };
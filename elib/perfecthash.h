@@ -0,0 +1,292 @@
+/*
+  ELib
+
+  Compile-time perfect hashing of fixed name sets
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <string_view>
+
+#include "../hal/hal_platform.h"
+
+// At run time words are loaded directly where that yields the same value as
+// assembling them byte by byte in a constant expression.
+#if (defined(_MSC_VER) && _MSC_VER >= 1925) || \
+    ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(__clang__) && __clang_major__ >= 9)) && \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define EPERFECTHASH_LOAD_DIRECT() (!__builtin_is_constant_evaluated())
+#else
+#define EPERFECTHASH_LOAD_DIRECT() false
+#endif
+
+//
+// Up to 8 bytes of name from pos, little-endian, with ASCII letters folded
+// to lowercase eight at a time.
+//
+constexpr uint64_t E_PerfectHashWord(std::string_view name, size_t pos) noexcept
+{
+    constexpr uint64_t ONES = 0x0101010101010101ull;
+
+    const char  *const p = name.data() + pos;
+    const size_t       n = (name.size() - pos < 8) ? name.size() - pos : 8;
+    uint64_t           w = 0;
+
+    if(EPERFECTHASH_LOAD_DIRECT())
+    {
+        if(n == 8)
+            std::memcpy(&w, p, 8);
+        else if(name.size() >= 8)
+        {
+            // the last 8 bytes of the name, shifted down to the n wanted
+            std::memcpy(&w, name.data() + name.size() - 8, 8);
+            w >>= 8 * (8 - n);
+        }
+        else if(n >= 4)
+        {
+            uint32_t lo = 0, hi = 0;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + n - 4, 4);
+            w = lo | (uint64_t(hi) << (8 * (n - 4)));
+        }
+        else if(n)
+        {
+            w = uint64_t(uint8_t(p[0])) | (uint64_t(uint8_t(p[n / 2])) << (8 * (n / 2))) |
+                (uint64_t(uint8_t(p[n - 1])) << (8 * (n - 1)));
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < n; i++)
+            w |= uint64_t(uint8_t(p[i])) << (8 * i);
+    }
+
+    const uint64_t low   = w & (0x7f * ONES);
+    const uint64_t upper = (low + (0x80 - 'A') * ONES) & ~(low + (0x80 - 'Z' - 1) * ONES) & ~w & (0x80 * ONES);
+    return w | (upper >> 2);
+}
+
+//
+// Hash a name, ignoring ASCII case. Usable in constant expressions, so that
+// a table built at compile time and a lookup made at run time agree.
+//
+constexpr uint64_t E_PerfectHashName(std::string_view name) noexcept
+{
+    uint64_t h = 0x243f6a8885a308d3ull ^ name.size();
+    for(size_t pos = 0; pos < name.size(); pos += 8)
+    {
+        h  = (h ^ E_PerfectHashWord(name, pos)) * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 29;
+    }
+    return h ^ (h >> 32);
+}
+
+//
+// Non-template view of an EPerfectHashTable, for code that must hold tables
+// of any size.
+//
+struct EPerfectHashView
+{
+    const std::string_view *names;
+    const uint32_t         *disps;
+    const uint16_t         *slots;
+    uint32_t                numBuckets;
+    uint32_t                slotMask;
+    uint32_t                count;
+
+    static constexpr uint16_t EMPTY = 0xffff;
+
+    // Slot of a name's hash under the displacement chosen for its bucket
+    static constexpr uint32_t Slot(uint64_t h, uint32_t disp, uint32_t mask) noexcept
+    {
+        uint64_t x = h ^ (uint64_t(disp) * 0x9e3779b97f4a7c15ull);
+        x ^= x >> 32;
+        x *= 0xd6e8feb86659fd93ull;
+        x ^= x >> 32;
+        return uint32_t(x) & mask;
+    }
+
+    // Bucket of a name's hash, by multiplication rather than division
+    static constexpr uint32_t Bucket(uint64_t h, uint32_t numBuckets) noexcept
+    {
+        return uint32_t((uint64_t(uint32_t(h >> 32)) * numBuckets) >> 32);
+    }
+
+    static constexpr bool NamesEqual(std::string_view a, std::string_view b) noexcept
+    {
+        if(a.size() != b.size())
+            return false;
+        for(size_t pos = 0; pos < a.size(); pos += 8)
+        {
+            if(E_PerfectHashWord(a, pos) != E_PerfectHashWord(b, pos))
+                return false;
+        }
+        return true;
+    }
+
+    //
+    // Index of name in the table, ignoring case, or -1: one hash, one compare.
+    //
+    constexpr int find(std::string_view name) const noexcept
+    {
+        if(!count)
+            return -1;
+
+        const uint64_t h   = E_PerfectHashName(name);
+        const uint16_t idx = slots[Slot(h, disps[Bucket(h, numBuckets)], slotMask)];
+        return (idx != EMPTY && NamesEqual(names[idx], name)) ? int(idx) : -1;
+    }
+};
+
+//
+// Called if a name cannot be placed, which only happens when it is listed
+// twice. It is not constexpr, so a table built in a constant expression fails
+// to compile instead.
+//
+inline void E_PerfectHashFailed(const char *name)
+{
+    hal_platform.fatalError("EPerfectHashTable: cannot place name '%s'", name);
+}
+
+//
+// Perfect hash over a fixed set of names, ignoring case, built by hash and
+// displace: names are spread over buckets by one part of their hash, and each
+// bucket, largest first, is given the displacement that sends all of its
+// names to free slots. A table declared constexpr is built entirely by the
+// compiler.
+//
+template<size_t N>
+class EPerfectHashTable
+{
+public:
+    static_assert(N > 0 && N < EPerfectHashView::EMPTY, "EPerfectHashTable: bad name count");
+
+    static constexpr uint32_t NUM_BUCKETS = uint32_t(N / 2 + 1);
+
+    // At most half full, so displacements are found in a few tries
+    static constexpr uint32_t NUM_SLOTS = [] {
+        uint32_t slots = 1;
+        while(slots < 2 * N)
+            slots <<= 1;
+        return slots;
+    }();
+
+    constexpr explicit EPerfectHashTable(const char *const (&names)[N])
+    {
+        uint64_t hashes[N]                = {};
+        uint32_t bucketSizes[NUM_BUCKETS] = {};
+        uint32_t order[NUM_BUCKETS]       = {};
+
+        for(size_t i = 0; i < N; i++)
+        {
+            m_names[i] = names[i];
+            hashes[i]  = E_PerfectHashName(m_names[i]);
+            bucketSizes[EPerfectHashView::Bucket(hashes[i], NUM_BUCKETS)]++;
+
+            for(size_t j = 0; j < i; j++)
+            {
+                if(hashes[j] == hashes[i] && EPerfectHashView::NamesEqual(m_names[j], m_names[i]))
+                    E_PerfectHashFailed(names[i]);
+            }
+        }
+        for(uint16_t &slot : m_slots)
+            slot = EPerfectHashView::EMPTY;
+
+        // place the largest buckets first, while the slots are emptiest
+        for(uint32_t b = 0; b < NUM_BUCKETS; b++)
+            order[b] = b;
+        for(uint32_t i = 0; i < NUM_BUCKETS; i++)
+        {
+            uint32_t largest = i;
+            for(uint32_t j = i + 1; j < NUM_BUCKETS; j++)
+            {
+                if(bucketSizes[order[j]] > bucketSizes[order[largest]])
+                    largest = j;
+            }
+            const uint32_t tmp = order[i];
+            order[i]       = order[largest];
+            order[largest] = tmp;
+        }
+
+        for(uint32_t i = 0; i < NUM_BUCKETS && bucketSizes[order[i]]; i++)
+        {
+            const uint32_t bucket = order[i];
+
+            size_t   members[N] = {};
+            uint32_t targets[N] = {};
+            size_t   numMembers = 0;
+            for(size_t n = 0; n < N; n++)
+            {
+                if(EPerfectHashView::Bucket(hashes[n], NUM_BUCKETS) == bucket)
+                    members[numMembers++] = n;
+            }
+
+            for(uint32_t disp = 0; ; disp++)
+            {
+                if(disp == UINT32_MAX)
+                    E_PerfectHashFailed(names[members[0]]);
+
+                bool fits = true;
+                for(size_t m = 0; m < numMembers && fits; m++)
+                {
+                    targets[m] = EPerfectHashView::Slot(hashes[members[m]], disp, NUM_SLOTS - 1);
+                    if(m_slots[targets[m]] != EPerfectHashView::EMPTY)
+                        fits = false;
+                    for(size_t k = 0; k < m && fits; k++)
+                    {
+                        if(targets[k] == targets[m])
+                            fits = false;
+                    }
+                }
+                if(fits)
+                {
+                    for(size_t m = 0; m < numMembers; m++)
+                        m_slots[targets[m]] = uint16_t(members[m]);
+                    m_disps[bucket] = disp;
+                    break;
+                }
+            }
+        }
+    }
+
+    constexpr EPerfectHashView getView() const noexcept
+    {
+        return { m_names, m_disps, m_slots, NUM_BUCKETS, NUM_SLOTS - 1, uint32_t(N) };
+    }
+
+    constexpr int find(std::string_view name) const noexcept { return getView().find(name); }
+
+    constexpr size_t size() const noexcept { return N; }
+    constexpr std::string_view getName(size_t idx) const noexcept { return m_names[idx]; }
+
+private:
+    std::string_view m_names[N]           = {};
+    uint32_t         m_disps[NUM_BUCKETS] = {};
+    uint16_t         m_slots[NUM_SLOTS]   = {};
+};
+
+// EOF
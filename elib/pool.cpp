@@ -0,0 +1,266 @@
+/*
+  ELib
+
+  Small object pool allocation
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <mutex>
+
+#include "elib.h"
+#include "arena.h"
+#include "pool.h"
+
+//=============================================================================
+//
+// Size Classes
+//
+
+static constexpr size_t POOL_GRANULARITY = 16;
+static constexpr size_t POOL_NUMCLASSES  = E_POOL_MAXSIZE / POOL_GRANULARITY;
+static constexpr size_t POOL_SLABSIZE    = 16 * 1024;
+
+// Free objects are threaded through their own first word.
+struct poolnode_t
+{
+    poolnode_t *next;
+};
+
+//
+// Shared state for one size class. Slabs are carved lazily so that a new slab
+// only costs one heap allocation, and are never returned to the heap.
+//
+struct poolclass_t
+{
+    std::mutex  lock;
+    poolnode_t *freeList = nullptr;
+    ebyte      *slabTop  = nullptr; // next uncarved object in the current slab
+    ebyte      *slabEnd  = nullptr;
+};
+
+static poolclass_t pool_classes[POOL_NUMCLASSES];
+
+static inline size_t PoolClassForSize(size_t size)
+{
+    return size ? (size - 1) / POOL_GRANULARITY : 0;
+}
+
+static inline size_t PoolClassSize(size_t cls)
+{
+    return (cls + 1) * POOL_GRANULARITY;
+}
+
+//
+// Take up to count objects of a class from the shared state, linked into a
+// list. Called with the class lock held.
+//
+static poolnode_t *PoolTakeShared(size_t cls, size_t count)
+{
+    poolclass_t &pc      = pool_classes[cls];
+    const size_t objsize = PoolClassSize(cls);
+    poolnode_t  *head    = nullptr;
+
+    while(count && pc.freeList)
+    {
+        poolnode_t *const node = pc.freeList;
+        pc.freeList = node->next;
+        node->next  = head;
+        head = node;
+        --count;
+    }
+
+    while(count)
+    {
+        if(pc.slabTop == pc.slabEnd)
+        {
+            // slabs always come from the heap, even if an arena is routed
+            EArena *const prevArena = E_SetCurrentArena(nullptr);
+            pc.slabTop = static_cast<ebyte *>(E_Malloc(POOL_SLABSIZE));
+            E_SetCurrentArena(prevArena);
+            pc.slabEnd = pc.slabTop + (POOL_SLABSIZE / objsize) * objsize;
+        }
+
+        poolnode_t *const node = reinterpret_cast<poolnode_t *>(pc.slabTop);
+        pc.slabTop += objsize;
+        node->next = head;
+        head = node;
+        --count;
+    }
+
+    return head;
+}
+
+//
+// Return a list of objects to the shared state. Called with the class lock held.
+//
+static void PoolGiveShared(size_t cls, poolnode_t *head)
+{
+    poolclass_t &pc = pool_classes[cls];
+
+    while(head)
+    {
+        poolnode_t *const next = head->next;
+        head->next  = pc.freeList;
+        pc.freeList = head;
+        head = next;
+    }
+}
+
+//=============================================================================
+//
+// Thread-Local Caches
+//
+// Each thread keeps a short free list per class so that the common path
+// takes no lock. Define ELIB_POOL_NO_THREADCACHE to always go through the
+// shared lists instead.
+//
+
+#if !defined(ELIB_POOL_NO_THREADCACHE)
+
+static constexpr size_t POOL_CACHEBATCH = 32;            // objects moved per refill or flush
+static constexpr size_t POOL_CACHEMAX   = POOL_CACHEBATCH * 2;
+
+struct poolcache_t
+{
+    poolnode_t *lists[POOL_NUMCLASSES]  = {};
+    size_t      counts[POOL_NUMCLASSES] = {};
+
+    // hand everything back when the thread exits
+    ~poolcache_t()
+    {
+        for(size_t cls = 0; cls < POOL_NUMCLASSES; cls++)
+        {
+            if(lists[cls])
+            {
+                std::lock_guard<std::mutex> guard(pool_classes[cls].lock);
+                PoolGiveShared(cls, lists[cls]);
+            }
+        }
+    }
+};
+
+static thread_local poolcache_t pool_cache;
+
+static void *PoolAllocClass(size_t cls)
+{
+    poolcache_t &cache = pool_cache;
+
+    if(!cache.lists[cls])
+    {
+        std::lock_guard<std::mutex> guard(pool_classes[cls].lock);
+        cache.lists[cls]  = PoolTakeShared(cls, POOL_CACHEBATCH);
+        cache.counts[cls] = POOL_CACHEBATCH;
+    }
+
+    poolnode_t *const node = cache.lists[cls];
+    cache.lists[cls] = node->next;
+    --cache.counts[cls];
+
+    return node;
+}
+
+static void PoolFreeClass(void *ptr, size_t cls)
+{
+    poolcache_t &cache = pool_cache;
+    poolnode_t *const node = static_cast<poolnode_t *>(ptr);
+
+    node->next = cache.lists[cls];
+    cache.lists[cls] = node;
+
+    // keep the cache bounded; spill half back to the shared list
+    if(++cache.counts[cls] > POOL_CACHEMAX)
+    {
+        poolnode_t *head = cache.lists[cls];
+        poolnode_t *tail = head;
+        for(size_t i = 1; i < POOL_CACHEBATCH; i++)
+            tail = tail->next;
+
+        cache.lists[cls]   = tail->next;
+        cache.counts[cls] -= POOL_CACHEBATCH;
+        tail->next = nullptr;
+
+        std::lock_guard<std::mutex> guard(pool_classes[cls].lock);
+        PoolGiveShared(cls, head);
+    }
+}
+
+#else
+
+static void *PoolAllocClass(size_t cls)
+{
+    std::lock_guard<std::mutex> guard(pool_classes[cls].lock);
+    return PoolTakeShared(cls, 1);
+}
+
+static void PoolFreeClass(void *ptr, size_t cls)
+{
+    poolnode_t *const node = static_cast<poolnode_t *>(ptr);
+    node->next = nullptr;
+
+    std::lock_guard<std::mutex> guard(pool_classes[cls].lock);
+    PoolGiveShared(cls, node);
+}
+
+#endif
+
+//=============================================================================
+//
+// External Interface
+//
+
+//
+// Allocate a small object. Requests above E_POOL_MAXSIZE go to E_Malloc.
+//
+void *E_PoolAlloc(size_t size)
+{
+    if(size > E_POOL_MAXSIZE)
+        return E_Malloc(size);
+
+    return PoolAllocClass(PoolClassForSize(size));
+}
+
+//
+// Allocate a small object and clear it.
+//
+void *E_PoolCalloc(size_t size)
+{
+    return std::memset(E_PoolAlloc(size), 0, size);
+}
+
+//
+// Return a small object to its size class. The size must be the same as the
+// one it was allocated with.
+//
+void E_PoolFree(void *ptr, size_t size)
+{
+    if(!ptr)
+        return;
+
+    if(size > E_POOL_MAXSIZE)
+        E_Free(ptr);
+    else
+        PoolFreeClass(ptr, PoolClassForSize(size));
+}
+
+// EOF
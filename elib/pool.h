@@ -0,0 +1,183 @@
+/*
+  ELib
+
+  Small object pool allocation
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+// Largest request served by the size-class pool; anything bigger goes to the heap.
+#define E_POOL_MAXSIZE 256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Size-class allocation for small objects. Requests are rounded up to a
+// multiple of 16 bytes and served from per-class free lists which refill from
+// large slabs. Memory must be returned through E_PoolFree with the same size
+// that was passed when it was allocated.
+//
+void *E_PoolAlloc(size_t size);
+void *E_PoolCalloc(size_t size);
+void  E_PoolFree(void *ptr, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(__cplusplus)
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+//
+// Derive from this to have new and delete of a type, including through ecnew
+// and ecnewarray, served from the size-class pool. The type must be deleted
+// through a pointer to its most derived class, or have a virtual destructor.
+//
+class EPoolAllocated
+{
+public:
+    static void *operator new   (size_t size) { return E_PoolAlloc(size); }
+    static void *operator new [](size_t size) { return E_PoolAlloc(size); }
+    static void  operator delete   (void *ptr, size_t size) noexcept { E_PoolFree(ptr, size); }
+    static void  operator delete [](void *ptr, size_t size) noexcept { E_PoolFree(ptr, size); }
+};
+
+//
+// Free-list pool for objects of a single type. Storage is taken from the heap
+// one slab at a time and is only returned when the pool is destroyed. Unlike
+// the size-class pool this is not thread-safe; it is intended to be owned by
+// the structure whose nodes it provides.
+//
+template<typename T>
+class EPool
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "EPool: over-aligned types are not supported");
+
+public:
+    explicit EPool(size_t objectsPerSlab = 64) noexcept
+        : m_perSlab(objectsPerSlab ? objectsPerSlab : 1)
+    {
+    }
+
+    // Frees all slabs. Objects still live are not destructed.
+    ~EPool()
+    {
+        while(m_slabs)
+        {
+            slab_t *const next = m_slabs->next;
+            efree(m_slabs);
+            m_slabs = next;
+        }
+    }
+
+    // non-copyable
+    EPool(const EPool &) = delete;
+    EPool &operator = (const EPool &) = delete;
+
+    //
+    // Get uninitialized storage for one object.
+    //
+    void *allocate()
+    {
+        if(!m_free)
+            refill();
+
+        node_t *const node = m_free;
+        m_free = node->next;
+        return node->storage;
+    }
+
+    //
+    // Return storage for one object to the free list.
+    //
+    void deallocate(void *ptr) noexcept
+    {
+        if(!ptr)
+            return;
+
+        node_t *const node = static_cast<node_t *>(ptr);
+        node->next = m_free;
+        m_free = node;
+    }
+
+    template<typename... Args>
+    T *construct(Args &&...args)
+    {
+        return new (allocate()) T { std::forward<Args>(args)... };
+    }
+
+    void destroy(T *obj)
+    {
+        if(obj)
+        {
+            obj->~T();
+            deallocate(obj);
+        }
+    }
+
+protected:
+    union node_t
+    {
+        node_t *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct slab_t
+    {
+        slab_t *next;
+    };
+
+    static constexpr size_t SLAB_HEADER = (sizeof(slab_t) + alignof(node_t) - 1) & ~(alignof(node_t) - 1);
+
+    node_t *m_free  = nullptr;
+    slab_t *m_slabs = nullptr;
+    size_t  m_perSlab;
+
+    //
+    // Carve a new slab into the free list.
+    //
+    void refill()
+    {
+        auto slab = static_cast<slab_t *>(E_Malloc(SLAB_HEADER + m_perSlab * sizeof(node_t)));
+        slab->next = m_slabs;
+        m_slabs = slab;
+
+        node_t *const nodes = reinterpret_cast<node_t *>(reinterpret_cast<unsigned char *>(slab) + SLAB_HEADER);
+        for(size_t i = m_perSlab; i-- > 0; )
+        {
+            nodes[i].next = m_free;
+            m_free = &nodes[i];
+        }
+    }
+};
+
+#endif
+
+// EOF
@@ -44,11 +44,9 @@ void qstring::unLocalize(size_t pSize)
 {
    if(isLocal())
    {
-      buffer = ecalloc(char, 1, pSize);
+      buffer = emalloc(char, pSize);
       size   = pSize;
-      strcpy(buffer, local);
-
-      memset(local, 0, basesize);
+      std::memcpy(buffer, local, index + 1);
    }
 }
 
@@ -104,15 +102,14 @@ void qstring::moveFrom(qstring &&other) noexcept
       buffer = other.buffer;
       index  = other.index;
       size   = other.size;
-      std::memset(local, 0, sizeof(local));
 
       other.buffer = nullptr;
       other.freeBuffer(); // returns to being localized
    }
    else
    {
-      // Copy the local buffer
-      std::memcpy(local, other.local, sizeof(local));
+      // Copy the local buffer, up to its terminator
+      std::memcpy(local, other.local, other.index + 1);
       buffer = local;
       index  = other.index;
    }
@@ -164,9 +161,29 @@ const char &qstring::operator [] (size_t idx) const
 //
 
 //
-// Grows the qstring's buffer by the indicated amount. This is automatically
-// called by other qstring methods, so there is generally no need to call it 
-// yourself.
+// Ensures the buffer can hold at least the indicated number of bytes,
+// including the terminator. Capacity grows by half again its current size, or
+// by at least growstep bytes, so runs of appends cost amortized constant time
+// instead of a reallocation each.
+//
+void qstring::makeRoom(size_t needed)
+{
+   if(needed <= size)
+      return;
+
+   size_t newsize = size + size / 2;
+   if(newsize < size + growstep)
+      newsize = size + growstep;
+   if(newsize < needed)
+      newsize = needed;
+
+   grow(newsize - size);
+}
+
+//
+// Grows the qstring's buffer by exactly the indicated amount. Mutating methods
+// use a geometric policy internally, so there is generally no need to call it
+// yourself; see also qstring::reserve.
 //
 qstring &qstring::grow(size_t len)
 {   
@@ -182,34 +199,81 @@ qstring &qstring::grow(size_t len)
       else
       {
          buffer = erealloc(char, buffer, newsize);
-         std::memset(buffer + size, 0, len);
-         size += len;
+         size   = newsize;
       }
    }
 
    return *this;
 }
 
+//
+// Ensures the buffer is at least the indicated size, without changing the
+// contents. Unlike most other methods, the size requested is honored exactly.
+//
+qstring &qstring::reserve(size_t capacity)
+{
+   if(capacity > size)
+      grow(capacity - size);
+
+   return *this;
+}
+
+//
+// Releases any buffer space beyond what the current contents require. A
+// string short enough to fit returns to being localized.
+//
+qstring &qstring::shrinkToFit()
+{
+   if(isLocal())
+      return *this;
+
+   const size_t needed = index + 1;
+
+   if(needed <= basesize)
+   {
+      char *const oldbuffer = buffer;
+
+      std::memcpy(local, oldbuffer, needed);
+      buffer = local;
+      size   = basesize;
+      efree(oldbuffer);
+   }
+   else if(needed < size)
+   {
+      buffer = erealloc(char, buffer, needed);
+      size   = needed;
+   }
+
+   return *this;
+}
+
 //=============================================================================
 // 
 // Concatenation and Insertion/Deletion/Copying Functions
 //
 
 //
-// Concatenates a C string onto the end of a qstring, expanding the buffer if
-// necessary.
+// Concatenates a string view onto the end of a qstring, expanding the buffer
+// if necessary. The C string and qstring overloads route through here.
 //
-qstring &qstring::concat(const char *str)
+qstring &qstring::concat(std::string_view sv)
 {
-   const size_t cursize = size;
-   const size_t newsize = index + std::strlen(str) + 1;
-
-   if(newsize > cursize)
-      grow(newsize - cursize);
+   const char  *str = sv.data();
+   const size_t len = sv.size();
 
-   std::strcat(buffer, str);
+   // str may point into our own buffer, which growing can move
+   if(str >= buffer && str < buffer + size)
+   {
+      const size_t offset = str - buffer;
+      makeRoom(index + len + 1);
+      str = buffer + offset;
+   }
+   else
+      makeRoom(index + len + 1);
 
-   index = std::strlen(buffer);
+   std::memmove(buffer + index, str, len);
+   index += len;
+   buffer[index] = '\0';
 
    return *this;
 }
@@ -253,17 +317,16 @@ qstring &qstring::insert(const char *insertstr, size_t pos)
       hal_platform.fatalError("qstring::insert: position out of range");
 
    // grow the buffer to hold the resulting string if necessary
-   if(totalsize > size)
-      grow(totalsize - size);
+   makeRoom(totalsize);
 
    char   *insertpoint = buffer + pos;
    size_t  charstomove = index  - pos;
 
-   // use memmove for absolute safety
-   std::memmove(insertpoint + insertstrlen, insertpoint, charstomove);
+   // use memmove for absolute safety; the terminator moves along
+   std::memmove(insertpoint + insertstrlen, insertpoint, charstomove + 1);
    std::memmove(insertpoint, insertstr, insertstrlen);
 
-   index = std::strlen(buffer);
+   index += insertstrlen;
 
    return *this;
 }
@@ -278,11 +341,9 @@ qstring &qstring::copy(const char *str, size_t count)
 
     if(count > 0)
     {
-        const size_t newsize = count + 1;
-        if(newsize > size)
-            grow(newsize - size);
+        makeRoom(count + 1);
 
-        M_Strlcpy(buffer, str, newsize);
+        M_Strlcpy(buffer, str, count + 1);
         index = std::strlen(buffer);
     }
 
@@ -329,7 +390,7 @@ qstring &qstring::lstrip(char c)
       else
       {
          std::memmove(buffer, buffer + i, len);
-         std::memset(buffer + len, 0, size - len);
+         buffer[len] = '\0';
          index -= i;
       }
    }
@@ -357,7 +418,7 @@ qstring &qstring::truncate(size_t pos)
    if(pos >= index)
       hal_platform.fatalError("qstring::truncate: position out of range");
 
-   std::memset(buffer + pos, 0, index - pos);
+   buffer[pos] = '\0';
    index = pos;
 
    return *this;
@@ -382,17 +443,8 @@ qstring &qstring::erase(size_t pos, size_t n)
    if(endPos > index)
       endPos = index;
 
-   char *to   = buffer + pos;
-   char *from = buffer + endPos;
-   char *const end = buffer + index;
-
-   while(to != end)
-   {
-      *to = *from;
-      ++to;
-      if(from != end)
-         ++from;
-   }
+   // shift the tail down, including the terminator
+   std::memmove(buffer + pos, buffer + endPos, index - endPos + 1);
 
    index -= (endPos - pos);
    return *this;
@@ -422,19 +474,19 @@ qstring &qstring::operator << (double d)
 // These are just convenience wrappers.
 //
 
+#if defined(ELIB_QSTRING_LEGACY_HASH)
+
 //
-// Static version, for convenience and so that the convention of hashing a
-// null pointer to 0 hash code is enforceable without special checks, even
-// if the thing being hashed isn't a qstring instance.
+// Original SDBM-style hashes, for code that depends on their exact values.
+// Define ELIB_QSTRING_LEGACY_HASH to select them.
 //
-unsigned int qstring::HashCodeStatic(const char *str)
+unsigned int qstring::HashCodeStatic(std::string_view sv)
 {
-   auto ustr = reinterpret_cast<const unsigned char *>(str);
-   int c;
+   auto ustr = reinterpret_cast<const unsigned char *>(sv.data());
    unsigned int h = 0;
 
-   while((c = *ustr++))
-      h = ectype::toUpper(c) + (h << 6) + (h << 16) - h;
+   for(size_t i = 0; i < sv.size() && ustr[i]; i++)
+      h = ectype::toUpper(ustr[i]) + (h << 6) + (h << 16) - h;
 
    return h;
 }
@@ -442,18 +494,68 @@ unsigned int qstring::HashCodeStatic(const char *str)
 //
 // As above, but with case sensitivity.
 //
-unsigned int qstring::HashCodeCaseStatic(const char *str)
+unsigned int qstring::HashCodeCaseStatic(std::string_view sv)
 {
-   auto ustr = reinterpret_cast<const unsigned char *>(str);
-   int c;
+   auto ustr = reinterpret_cast<const unsigned char *>(sv.data());
    unsigned int h = 0;
 
-   while((c = *ustr++))
-      h = c + (h << 6) + (h << 16) - h;
+   for(size_t i = 0; i < sv.size() && ustr[i]; i++)
+      h = ustr[i] + (h << 6) + (h << 16) - h;
 
    return h;
 }
 
+#else
+
+//
+// Case-insensitive hash over an explicit length. The null pointer convention
+// of hashing to 0 is enforced by the C string overloads.
+//
+unsigned int qstring::HashCodeStatic(std::string_view sv)
+{
+   const uint64_t h = M_HashBytesNoCase(sv.data(), sv.size());
+   return static_cast<unsigned int>(h ^ (h >> 32));
+}
+
+//
+// As above, but with case sensitivity.
+//
+unsigned int qstring::HashCodeCaseStatic(std::string_view sv)
+{
+   const uint64_t h = M_HashBytes(sv.data(), sv.size());
+   return static_cast<unsigned int>(h ^ (h >> 32));
+}
+
+#endif
+
+//=============================================================================
+//
+// Case-Insensitive Comparison
+//
+
+//
+// Case-insensitive equality of two views; used by qstring::charequal.
+//
+bool qstring::EqualNoCase(std::string_view a, std::string_view b)
+{
+   return a.size() == b.size() && !M_MemCaseCmp(a.data(), b.data(), a.size());
+}
+
+//
+// Length-aware equivalent of strCaseCmp. A string that is a prefix of the
+// other sorts first.
+//
+int qstring::strCaseCmp(std::string_view sv) const
+{
+   const size_t n   = emin(index, sv.size());
+   const int    res = M_MemCaseCmp(buffer, sv.data(), n);
+
+   if(res || index == sv.size())
+      return res;
+
+   return index < sv.size() ? -1 : 1;
+}
+
 //=============================================================================
 //
 // Conversion Functions
@@ -569,17 +671,9 @@ size_t qstring::findLastOf(char c) const
 //
 // Case-insensitive substring find
 //
-const char *qstring::findSubStrNoCase(const char *substr) const
+const char *qstring::findSubStrNoCase(std::string_view substr) const
 {
-    return M_StrCaseStr(buffer, substr);
-}
-
-//
-// Case-insensitive substring check
-//
-bool qstring::containsNoCase(const char *needle) const
-{
-    return (M_StrCaseStr(buffer, needle) != nullptr);
+    return M_MemCaseMem(buffer, index, substr.data(), substr.size());
 }
 
 //
@@ -866,10 +960,8 @@ int qstring::vprintf(const char *fmt, va_list va)
     if(stringLength >= 0)
     {
         const size_t bufferLength = size_t(stringLength + 1);
-        const size_t curLength    = size;
-        
-        if(bufferLength > curLength)
-            grow(bufferLength - curLength);
+
+        makeRoom(bufferLength);
 
         stringLength = std::vsnprintf(buffer, bufferLength, fmt, va);
         if(stringLength >= 0)
@@ -38,7 +38,10 @@ class qstring
 {
 public:
     static constexpr size_t npos = ((size_t) -1);
-    static constexpr size_t basesize = 16;
+
+    // Size of the inline buffer. On 64-bit targets this makes the whole object
+    // exactly one 64-byte cache line.
+    static constexpr size_t basesize = 40;
 
     static const qstring emptystr;
 
@@ -48,7 +51,7 @@ public:
        : index(0), size(basesize)
     {
         buffer = local;
-        std::memset(local, 0, sizeof(local));
+        local[0] = '\0';
         if(startSize)
             createSize(startSize);
     }
@@ -57,7 +60,7 @@ public:
        : index(0), size(basesize)
     {
         buffer = local;
-        std::memset(local, 0, sizeof(local));
+        local[0] = '\0';
         copy(other);
     }
     
@@ -65,7 +68,7 @@ public:
        : index(0), size(basesize)
     {
         buffer = local;
-        std::memset(local, 0, sizeof(local));
+        local[0] = '\0';
         copy(cstr);
     }
 
@@ -73,10 +76,15 @@ public:
         : index(0), size(basesize)
     {
         buffer = local;
-        std::memset(local, 0, sizeof(local));
+        local[0] = '\0';
         copy(start, len);
     }
 
+    explicit qstring(std::string_view sv) noexcept
+        : qstring(sv.data(), sv.size())
+    {
+    }
+
     qstring(qstring &&other) noexcept
         : index(0), size(basesize)
     {
@@ -111,9 +119,9 @@ public:
     bool empty() const { return (index == 0); }
 
     //
-    // Returns the amount of size allocated for this qstring (will be >= strlen).
-    // You are allowed to index into the qstring up to size - 1, although any bytes
-    // beyond the strlen will be zero.
+    // Returns the amount of size allocated for this qstring (will be > strlen).
+    // You are allowed to index into the qstring up to size - 1, but the contents
+    // of any bytes beyond the terminating null are unspecified.
     //
     size_t getSize() const { return size; }
     
@@ -122,21 +130,23 @@ public:
     qstring &createSize(size_t size);
     
     //
-    // Gives the qstring a buffer of the default size and initializes
-    // it to zero. Resets insertion point to zero. This is safe to call
+    // Gives the qstring a buffer of the default size and empties it.
+    // Resets insertion point to zero. This is safe to call
     // on an existing qstring to reinitialize it.
     //
     qstring &create() { return createSize(basesize); }
     
     qstring &grow(size_t len);
+    qstring &reserve(size_t capacity);
+    qstring &shrinkToFit();
 
     //
-    // Sets the entire qstring buffer to zero, and resets the insertion index. 
-    // Does not reallocate the buffer.
+    // Empties the qstring by terminating it at the start of the buffer, and
+    // resets the insertion index. Does not reallocate the buffer.
     //
     qstring &clear()
     {
-        std::memset(buffer, 0, size);
+        buffer[0] = '\0';
         index = 0;
     
         return *this;
@@ -159,15 +169,16 @@ public:
     // === Concatenation and insertion/deletion =========================================
     
     //
-    // Adds a character to the end of the qstring, reallocating via buffer doubling
-    // if necessary.
+    // Adds a character to the end of the qstring, reallocating via geometric
+    // growth if necessary.
     //
     qstring &push(char ch)
     {
-        if(index >= size - 1) // leave room for \0
-            grow(size);       // double buffer size
+        if(index >= size - 1)   // leave room for \0
+            makeRoom(index + 2);
 
         buffer[index++] = ch;
+        buffer[index]   = '\0';
 
         return *this;
     }
@@ -183,8 +194,9 @@ public:
         return *this;
     }
 
-    qstring &concat(const char *str);
-    qstring &concat(const qstring &src) { return concat(src.buffer); }
+    qstring &concat(std::string_view str);
+    qstring &concat(const char *str)    { return concat(std::string_view(str)); }
+    qstring &concat(const qstring &src) { return concat(src.getView());         }
     qstring &concat(qstring &&src);
 
     qstring &insert(const char *insertstr, size_t pos);
@@ -196,28 +208,79 @@ public:
     int  strnCmp(const char *str, size_t maxcount)     const { return std::strncmp(buffer, str, maxcount); }
     int  strCaseCmp(const char *str)                   const { return strcasecmp(buffer, str);             }
     int  strnCaseCmp(const char *str, size_t maxcount) const { return strncasecmp(buffer, str, maxcount);  }
+
+    int strCaseCmp(std::string_view sv) const;
+    int strCaseCmp(const qstring &other) const { return strcasecmp(buffer, other.buffer); }
     bool compare(const char *str)                      const { return !std::strcmp(buffer, str);           }
-    bool compare(const qstring &other)                 const { return !std::strcmp(buffer, other.buffer);  }
+
+    //
+    // Length-aware equality tests. Strings of differing length are rejected
+    // without examining their contents.
+    //
+    bool compare(std::string_view sv) const
+    {
+        return index == sv.size() && !std::memcmp(buffer, sv.data(), index);
+    }
+    bool compare(const qstring &other) const { return compare(other.getView()); }
     
-    bool operator < (const qstring &other) const { return std::strcmp(buffer, other.buffer) < 0; }
-    bool operator > (const qstring &other) const { return std::strcmp(buffer, other.buffer) > 0; }
+    bool operator < (const qstring &other) const { return getView().compare(other.getView()) < 0; }
+    bool operator > (const qstring &other) const { return getView().compare(other.getView()) > 0; }
 
     // === Hashing ======================================================================
 
-    static unsigned int HashCodeStatic(const char *str);
-    static unsigned int HashCodeCaseStatic(const char *str);
+    static unsigned int HashCodeStatic(std::string_view sv);
+    static unsigned int HashCodeCaseStatic(std::string_view sv);
+    static unsigned int HashCodeStatic(const char *str)
+    {
+        return str ? HashCodeStatic(std::string_view(str)) : 0;
+    }
+    static unsigned int HashCodeCaseStatic(const char *str)
+    {
+        return str ? HashCodeCaseStatic(std::string_view(str)) : 0;
+    }
     
-    unsigned int hashCode()     const { return HashCodeStatic(buffer);     } // case-ignoring
-    unsigned int hashCodeCase() const { return HashCodeCaseStatic(buffer); } // case-considering
+    unsigned int hashCode()     const { return HashCodeStatic(getView());     } // case-ignoring
+    unsigned int hashCodeCase() const { return HashCodeCaseStatic(getView()); } // case-considering
+
+    static bool EqualNoCase(std::string_view a, std::string_view b);
 
+    //
+    // Hash and equality functors for string-keyed containers. Following the
+    // hashCode naming above, the plain versions ignore case and the "case"
+    // versions consider it. All are transparent, so a container keyed by
+    // qstring can be searched with a C string or string view without building
+    // a temporary qstring.
+    //
     struct charhash
     {
-        size_t operator () (const char *str) const noexcept { return HashCodeStatic(str); }
+        using is_transparent = void;
+
+        size_t operator () (const char *str)      const noexcept { return HashCodeStatic(str);            }
+        size_t operator () (std::string_view sv)  const noexcept { return HashCodeStatic(sv);             }
+        size_t operator () (const qstring &qstr)  const noexcept { return HashCodeStatic(qstr.getView()); }
     };
 
     struct charcasehash
     {
-        size_t operator () (const char *str) const noexcept { return HashCodeCaseStatic(str); }
+        using is_transparent = void;
+
+        size_t operator () (const char *str)      const noexcept { return HashCodeCaseStatic(str);            }
+        size_t operator () (std::string_view sv)  const noexcept { return HashCodeCaseStatic(sv);             }
+        size_t operator () (const qstring &qstr)  const noexcept { return HashCodeCaseStatic(qstr.getView()); }
+    };
+
+    struct charequal
+    {
+        using is_transparent = void;
+
+        bool operator () (std::string_view a, std::string_view b) const noexcept { return EqualNoCase(a, b); }
+    };
+
+    struct charcaseequal
+    {
+        using is_transparent = void;
+
+        bool operator () (std::string_view a, std::string_view b) const noexcept { return a == b; }
     };
     
     // === Copying and Swapping =========================================================
@@ -234,7 +297,14 @@ public:
         return concat(str);
     }
 
-    qstring &copy(const qstring &src) { return copy(src.buffer); }
+    qstring &copy(const qstring &src)
+    {
+        if(index > 0)
+            clear();
+
+        return concat(src.getView());
+    }
+
     qstring &copy(const char *str, size_t count);
 
     //
@@ -314,7 +384,8 @@ public:
     size_t findLastNotOf(const char *c, size_t offs = npos) const { return getView().find_last_not_of(c, offs); }
   
     const char *findSubStr(const char *substr) const { return std::strstr(buffer, substr); }
-    const char *findSubStrNoCase(const char *substr) const;
+    const char *findSubStrNoCase(std::string_view substr) const;
+    const char *findSubStrNoCase(const char *substr) const { return findSubStrNoCase(std::string_view(substr)); }
     
     size_t find(const char *s, size_t pos = 0) const;
     size_t find(const qstring &s, size_t pos = 0) const { return find(s.buffer, pos); }
@@ -322,14 +393,28 @@ public:
     bool startsWith(char c) const { return buffer[0] == c; }
     bool endsWith(char c)   const { return index > 0 ? buffer[index - 1] == c : false; }
 
-    bool startsWith(const char *prefix)    const { return (std::strstr(buffer, prefix) == buffer); }
-    bool startsWith(const qstring &prefix) const { return startsWith(prefix.buffer); };
+    bool startsWith(std::string_view prefix) const
+    {
+        return index >= prefix.size() && !std::memcmp(buffer, prefix.data(), prefix.size());
+    }
+    bool startsWith(const char *prefix)    const { return startsWith(std::string_view(prefix)); }
+    bool startsWith(const qstring &prefix) const { return startsWith(prefix.getView());         }
+
+    bool endsWith(std::string_view suffix) const
+    {
+        return index >= suffix.size() && 
+               !std::memcmp(buffer + index - suffix.size(), suffix.data(), suffix.size());
+    }
+    bool endsWith(const char *suffix)    const { return endsWith(std::string_view(suffix)); }
+    bool endsWith(const qstring &suffix) const { return endsWith(suffix.getView());         }
 
-    bool contains(const char *needle)    const { return std::strstr(buffer, needle) != nullptr; }
-    bool contains(const qstring &needle) const { return contains(needle.buffer); }
+    bool contains(const char *needle)      const { return std::strstr(buffer, needle) != nullptr;   }
+    bool contains(std::string_view needle) const { return getView().find(needle) != std::string_view::npos; }
+    bool contains(const qstring &needle)   const { return contains(needle.getView());               }
 
-    bool containsNoCase(const char *needle)    const;
-    bool containsNoCase(const qstring &needle) const { return containsNoCase(needle.buffer); }
+    bool containsNoCase(std::string_view needle) const { return findSubStrNoCase(needle) != nullptr; }
+    bool containsNoCase(const char *needle)      const { return findSubStrNoCase(needle) != nullptr; }
+    bool containsNoCase(const qstring &needle)   const { return containsNoCase(needle.getView());    }
 
     // === Stripping and Truncation =====================================================
 
@@ -349,10 +434,12 @@ public:
 
     // === Operators ====================================================================
 
-    bool operator     == (const char *other)    const { return !std::strcmp(buffer, other); }
-    bool operator     == (const qstring &other) const { return !std::strcmp(buffer, other.buffer); }
-    bool operator     != (const char *other)    const { return std::strcmp(buffer, other) != 0; }
-    bool operator     != (const qstring &other) const { return std::strcmp(buffer, other.buffer) != 0; }
+    bool operator     == (const char *other)      const { return !std::strcmp(buffer, other); }
+    bool operator     == (const qstring &other)   const { return compare(other);              }
+    bool operator     == (std::string_view other) const { return compare(other);              }
+    bool operator     != (const char *other)      const { return std::strcmp(buffer, other) != 0; }
+    bool operator     != (const qstring &other)   const { return !compare(other);             }
+    bool operator     != (std::string_view other) const { return !compare(other);             }
     qstring &operator  = (const qstring &other)       { return buffer != other.buffer ? copy(other) : *this; }
     qstring &operator  = (const char    *other)       { return buffer != other ? copy(other) : *this; }
     qstring operator  +  (const qstring &other) const { return qstring(*this).concat(other); }
@@ -407,6 +494,9 @@ public:
     const char &operator [] (size_t idx) const;
     
 private:
+    // Minimum number of bytes added whenever the buffer must be expanded
+    static constexpr size_t growstep = 32;
+
     char    local[basesize];
     char   *buffer;
     size_t  index;
@@ -414,10 +504,14 @@ private:
    
     bool isLocal() const { return (buffer == local); }
     void unLocalize(size_t pSize);
+    void makeRoom(size_t needed);
 
     void moveFrom(qstring &&other) noexcept;
 };
 
+// Keep the object within a single cache line.
+static_assert(sizeof(void *) != 8 || sizeof(qstring) <= 64, "qstring should fit in one cache line");
+
 // Specialization of std::hash for qstring
 template<>
 struct std::hash<qstring>
@@ -0,0 +1,197 @@
+/*
+  ELib
+
+  Byte order conversion of arrays
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "elib.h"
+#include "swap.h"
+
+//
+// Blocks of 16 bytes are reversed with a byte shuffle on SSSE3, or with word
+// shuffles and shifts on plain SSE2. Whatever is left over, and the whole
+// buffer elsewhere, goes through the scalar intrinsics a word at a time.
+//
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ELIB_SWAP_SSE2
+#include <emmintrin.h>
+#if defined(__SSSE3__) || defined(__AVX__)
+#define ELIB_SWAP_SSSE3
+#include <tmmintrin.h>
+#endif
+#endif
+
+#if defined(ELIB_SWAP_SSE2)
+
+static inline __m128i SwapLoad(const ebyte *p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+static inline void SwapStore(ebyte *p, __m128i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+}
+
+//
+// Swap the two bytes of each 16-bit lane.
+//
+static inline __m128i SwapBytes128(__m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static inline __m128i SwapVector16(__m128i v)
+{
+#if defined(ELIB_SWAP_SSSE3)
+    return _mm_shuffle_epi8(v, _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+#else
+    return SwapBytes128(v);
+#endif
+}
+
+static inline __m128i SwapVector32(__m128i v)
+{
+#if defined(ELIB_SWAP_SSSE3)
+    return _mm_shuffle_epi8(v, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+#else
+    // exchange the halves of each dword, then the bytes of each half
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return SwapBytes128(v);
+#endif
+}
+
+static inline __m128i SwapVector64(__m128i v)
+{
+#if defined(ELIB_SWAP_SSSE3)
+    return _mm_shuffle_epi8(v, _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7));
+#else
+    // reverse the words of each qword, then the bytes of each word
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    return SwapBytes128(v);
+#endif
+}
+
+//
+// Convert whole 64-byte and then 16-byte blocks, returning the bytes done.
+//
+template<__m128i (*swap)(__m128i)>
+static size_t SwapBlocks(ebyte *dst, const ebyte *src, size_t size)
+{
+    size_t i = 0;
+
+    // four independent vectors per round keep the loads in flight
+    for(; i + 64 <= size; i += 64)
+    {
+        const __m128i a = SwapLoad(src + i);
+        const __m128i b = SwapLoad(src + i + 16);
+        const __m128i c = SwapLoad(src + i + 32);
+        const __m128i d = SwapLoad(src + i + 48);
+        SwapStore(dst + i,      swap(a));
+        SwapStore(dst + i + 16, swap(b));
+        SwapStore(dst + i + 32, swap(c));
+        SwapStore(dst + i + 48, swap(d));
+    }
+    for(; i + 16 <= size; i += 16)
+        SwapStore(dst + i, swap(SwapLoad(src + i)));
+
+    return i;
+}
+
+#endif
+
+//
+// Reverse the bytes of each 16-bit value.
+//
+void E_SwapBuffer16(void *dst, const void *src, size_t count)
+{
+    auto         d    = static_cast<ebyte *>(dst);
+    auto         s    = static_cast<const ebyte *>(src);
+    const size_t size = count * 2;
+    size_t       i    = 0;
+
+#if defined(ELIB_SWAP_SSE2)
+    i = SwapBlocks<SwapVector16>(d, s, size);
+#endif
+
+    for(; i < size; i += 2)
+    {
+        uint16_t v;
+        std::memcpy(&v, s + i, 2);
+        v = E_ByteSwap16(v);
+        std::memcpy(d + i, &v, 2);
+    }
+}
+
+//
+// Reverse the bytes of each 32-bit value.
+//
+void E_SwapBuffer32(void *dst, const void *src, size_t count)
+{
+    auto         d    = static_cast<ebyte *>(dst);
+    auto         s    = static_cast<const ebyte *>(src);
+    const size_t size = count * 4;
+    size_t       i    = 0;
+
+#if defined(ELIB_SWAP_SSE2)
+    i = SwapBlocks<SwapVector32>(d, s, size);
+#endif
+
+    for(; i < size; i += 4)
+    {
+        uint32_t v;
+        std::memcpy(&v, s + i, 4);
+        v = E_ByteSwap32(v);
+        std::memcpy(d + i, &v, 4);
+    }
+}
+
+//
+// Reverse the bytes of each 64-bit value.
+//
+void E_SwapBuffer64(void *dst, const void *src, size_t count)
+{
+    auto         d    = static_cast<ebyte *>(dst);
+    auto         s    = static_cast<const ebyte *>(src);
+    const size_t size = count * 8;
+    size_t       i    = 0;
+
+#if defined(ELIB_SWAP_SSE2)
+    i = SwapBlocks<SwapVector64>(d, s, size);
+#endif
+
+    for(; i < size; i += 8)
+    {
+        uint64_t v;
+        std::memcpy(&v, s + i, 8);
+        v = E_ByteSwap64(v);
+        std::memcpy(d + i, &v, 8);
+    }
+}
+
+// EOF
@@ -100,5 +100,141 @@ inline static uint32_t E_SwapBigULong(uint32_t x)
            ((uint8_t *) &x)[3];
 }
 
+//=============================================================================
+//
+// Unconditional byte reversal, compiled to a single instruction where the
+// compiler offers one. MSVC declares its intrinsics in stdlib.h.
+//
+
+inline static uint16_t E_ByteSwap16(uint16_t x)
+{
+#if defined(_MSC_VER)
+   return _byteswap_ushort(x);
+#elif defined(__GNUC__)
+   return __builtin_bswap16(x);
+#else
+   return (uint16_t)((x << 8) | (x >> 8));
+#endif
+}
+
+inline static uint32_t E_ByteSwap32(uint32_t x)
+{
+#if defined(_MSC_VER)
+   return _byteswap_ulong(x);
+#elif defined(__GNUC__)
+   return __builtin_bswap32(x);
+#else
+   return (x << 24) | ((x & 0xff00u) << 8) | ((x >> 8) & 0xff00u) | (x >> 24);
+#endif
+}
+
+inline static uint64_t E_ByteSwap64(uint64_t x)
+{
+#if defined(_MSC_VER)
+   return _byteswap_uint64(x);
+#elif defined(__GNUC__)
+   return __builtin_bswap64(x);
+#else
+   return ((uint64_t)E_ByteSwap32((uint32_t)x) << 32) | E_ByteSwap32((uint32_t)(x >> 32));
+#endif
+}
+
+//=============================================================================
+//
+// Array conversion
+//
+// Each routine converts count values from src into dst, which may be the
+// same buffer as src for in-place conversion, but must not otherwise overlap
+// it. Neither needs any alignment.
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reverse the bytes of each 16-, 32-, or 64-bit value.
+void E_SwapBuffer16(void *dst, const void *src, size_t count);
+void E_SwapBuffer32(void *dst, const void *src, size_t count);
+void E_SwapBuffer64(void *dst, const void *src, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+//
+// Copy values whose byte order already matches; nothing to do in place.
+//
+inline static void E_CopyBuffer(void *dst, const void *src, size_t size)
+{
+   if(dst != src)
+      memcpy(dst, src, size);
+}
+
+//
+// Between little-endian or big-endian data and host order. Reading and
+// writing are the same operation, but are named apart for the reader's sake.
+//
+
+inline static void E_ReadLE16Array(void *dst, const void *src, size_t count)
+{
+#if defined(ELIB_BIG_ENDIAN)
+   E_SwapBuffer16(dst, src, count);
+#else
+   E_CopyBuffer(dst, src, count * 2);
+#endif
+}
+
+inline static void E_ReadLE32Array(void *dst, const void *src, size_t count)
+{
+#if defined(ELIB_BIG_ENDIAN)
+   E_SwapBuffer32(dst, src, count);
+#else
+   E_CopyBuffer(dst, src, count * 4);
+#endif
+}
+
+inline static void E_ReadLE64Array(void *dst, const void *src, size_t count)
+{
+#if defined(ELIB_BIG_ENDIAN)
+   E_SwapBuffer64(dst, src, count);
+#else
+   E_CopyBuffer(dst, src, count * 8);
+#endif
+}
+
+inline static void E_ReadBE16Array(void *dst, const void *src, size_t count)
+{
+#if !defined(ELIB_BIG_ENDIAN)
+   E_SwapBuffer16(dst, src, count);
+#else
+   E_CopyBuffer(dst, src, count * 2);
+#endif
+}
+
+inline static void E_ReadBE32Array(void *dst, const void *src, size_t count)
+{
+#if !defined(ELIB_BIG_ENDIAN)
+   E_SwapBuffer32(dst, src, count);
+#else
+   E_CopyBuffer(dst, src, count * 4);
+#endif
+}
+
+inline static void E_ReadBE64Array(void *dst, const void *src, size_t count)
+{
+#if !defined(ELIB_BIG_ENDIAN)
+   E_SwapBuffer64(dst, src, count);
+#else
+   E_CopyBuffer(dst, src, count * 8);
+#endif
+}
+
+inline static void E_WriteLE16Array(void *dst, const void *src, size_t count) { E_ReadLE16Array(dst, src, count); }
+inline static void E_WriteLE32Array(void *dst, const void *src, size_t count) { E_ReadLE32Array(dst, src, count); }
+inline static void E_WriteLE64Array(void *dst, const void *src, size_t count) { E_ReadLE64Array(dst, src, count); }
+inline static void E_WriteBE16Array(void *dst, const void *src, size_t count) { E_ReadBE16Array(dst, src, count); }
+inline static void E_WriteBE32Array(void *dst, const void *src, size_t count) { E_ReadBE32Array(dst, src, count); }
+inline static void E_WriteBE64Array(void *dst, const void *src, size_t count) { E_ReadBE64Array(dst, src, count); }
+
 // EOF
 
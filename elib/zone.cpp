@@ -26,56 +26,914 @@
   SOFTWARE.
 */
 
+#include <mutex>
+
+#if defined(ELIB_ZONE_STATS)
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#endif
+
 #include "elib.h"
 #include "../hal/hal_platform.h"
+#include "arena.h"
+#include "atexit.h"
+#include "bdlist.h"
 
-void *E_Malloc(size_t size)
+//=============================================================================
+//
+// Arena routing
+//
+// While an arena is current on a thread, zone allocations made by that thread
+// are carved out of it instead of the heap.
+//
+
+static thread_local EArena *e_currentArena;
+
+EArena *E_GetCurrentArena()
+{
+   return e_currentArena;
+}
+
+EArena *E_SetCurrentArena(EArena *arena)
+{
+   EArena *const prev = e_currentArena;
+   e_currentArena = arena;
+   return prev;
+}
+
+//=============================================================================
+//
+// Allocation Statistics
+//
+// When built with ELIB_ZONE_STATS, every heap block carries a small header
+// recording its size and, for sampled allocations, the call site that made
+// it. Global counters are exact and maintained with relaxed atomics; only
+// one allocation in every "sample rate" pays for call-site attribution.
+//
+
+#if defined(ELIB_ZONE_STATS)
+
+static constexpr uint32_t ZONE_MAGIC             = 0x5a4f4e45u; // "ZONE"
+static constexpr size_t   ZONE_HEADERSIZE        = alignof(std::max_align_t) < 16 ? 16 : alignof(std::max_align_t);
+static constexpr size_t   ZONE_MAXSITES          = 4096;
+static constexpr unsigned ZONE_DEFAULTSAMPLERATE = 64;
+
+struct zoneheader_t
+{
+   size_t   size;  // requested size
+   uint32_t site;  // index into zone_sites, 0 if not sampled
+   uint32_t magic; // ZONE_MAGIC while the block is live
+};
+
+static_assert(sizeof(zoneheader_t) <= ZONE_HEADERSIZE, "zoneheader_t must fit in ZONE_HEADERSIZE");
+
+struct zonesite_t
+{
+   std::atomic<const char *> file;
+   int                       line;
+   std::atomic<size_t>       liveBytes;
+   std::atomic<size_t>       liveBlocks;
+   std::atomic<size_t>       allocs;
+};
+
+static std::atomic<size_t> zone_liveBytes;
+static std::atomic<size_t> zone_peakBytes;
+static std::atomic<size_t> zone_liveBlocks;
+static std::atomic<size_t> zone_allocCount;
+static std::atomic<size_t> zone_freeCount;
+static std::atomic<size_t> zone_histogram[ZONE_NUMHISTBUCKETS];
+
+static zonesite_t              zone_sites[ZONE_MAXSITES]; // [0] is unused
+static std::mutex              zone_siteLock;
+static std::atomic<unsigned>   zone_sampleRate { ZONE_DEFAULTSAMPLERATE };
+static thread_local unsigned   zone_sampleCount;
+
+//
+// Histogram bucket for a size: the number of significant bits, so that
+// bucket n holds sizes in [2^(n-1), 2^n).
+//
+static size_t ZoneHistogramBucket(size_t size)
+{
+   size_t bucket = 0;
+   while(size && bucket < ZONE_NUMHISTBUCKETS - 1)
+   {
+      size >>= 1;
+      ++bucket;
+   }
+   return bucket;
+}
+
+//
+// Find or add the table slot for a call site. Lookups are lock-free; the
+// line is always published before the file pointer which marks a slot used.
+//
+static uint32_t ZoneSiteIndex(const char *file, int line)
+{
+   if(!file)
+      return 0;
+
+   const size_t hash  = (reinterpret_cast<uintptr_t>(file) >> 3) * 31 + size_t(line);
+   const size_t start = 1 + hash % (ZONE_MAXSITES - 1);
+   size_t       idx   = start;
+
+   do
+   {
+      zonesite_t &site = zone_sites[idx];
+      const char *const sfile = site.file.load(std::memory_order_acquire);
+
+      if(sfile == file && site.line == line)
+         return uint32_t(idx);
+
+      if(!sfile)
+      {
+         std::lock_guard<std::mutex> guard(zone_siteLock);
+
+         // someone else may have claimed it in the meantime
+         if(const char *const cfile = site.file.load(std::memory_order_relaxed); cfile == nullptr)
+         {
+            site.line = line;
+            site.file.store(file, std::memory_order_release);
+            return uint32_t(idx);
+         }
+         else if(cfile == file && site.line == line)
+            return uint32_t(idx);
+      }
+
+      if(++idx == ZONE_MAXSITES)
+         idx = 1;
+   }
+   while(idx != start);
+
+   return 0; // table is full; count the block as unattributed
+}
+
+//
+// Raise the recorded peak if live has passed it.
+//
+static void ZoneUpdatePeak(size_t live)
+{
+   size_t peak = zone_peakBytes.load(std::memory_order_relaxed);
+   while(live > peak && !zone_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+      ; // retry with updated peak
+}
+
+//
+// Account for a new heap block and return the user pointer following its header.
+//
+static void *ZoneRecordAlloc(void *block, size_t size, const char *file, int line)
+{
+   auto header = static_cast<zoneheader_t *>(block);
+   header->size  = size;
+   header->magic = ZONE_MAGIC;
+   header->site  = 0;
+
+   if(++zone_sampleCount >= zone_sampleRate.load(std::memory_order_relaxed))
+   {
+      zone_sampleCount = 0;
+      if((header->site = ZoneSiteIndex(file, line)) != 0)
+      {
+         zonesite_t &site = zone_sites[header->site];
+         site.liveBytes.fetch_add(size, std::memory_order_relaxed);
+         site.liveBlocks.fetch_add(1, std::memory_order_relaxed);
+         site.allocs.fetch_add(1, std::memory_order_relaxed);
+      }
+   }
+
+   ZoneUpdatePeak(zone_liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+
+   zone_liveBlocks.fetch_add(1, std::memory_order_relaxed);
+   zone_allocCount.fetch_add(1, std::memory_order_relaxed);
+   zone_histogram[ZoneHistogramBucket(size)].fetch_add(1, std::memory_order_relaxed);
+
+   return static_cast<ebyte *>(block) + ZONE_HEADERSIZE;
+}
+
+//
+// Validate the header in front of a user pointer and return it.
+//
+static zoneheader_t *ZoneGetHeader(void *ptr, const char *fn)
+{
+   auto header = reinterpret_cast<zoneheader_t *>(static_cast<ebyte *>(ptr) - ZONE_HEADERSIZE);
+   if(header->magic != ZONE_MAGIC)
+      hal_platform.fatalError("%s: pointer %p is not a live zone block", fn, ptr);
+   return header;
+}
+
+//
+// Account for a block leaving the heap.
+//
+static void ZoneRecordFree(const zoneheader_t *header)
+{
+   if(header->site)
+   {
+      zonesite_t &site = zone_sites[header->site];
+      site.liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+      site.liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+   }
+
+   zone_liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+   zone_liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+   zone_freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+//
+// Account for a block whose size changed from oldsize to header->size. The
+// counters wrap correctly when the block shrinks.
+//
+static void ZoneRecordResize(const zoneheader_t *header, size_t oldsize)
+{
+   const size_t delta = header->size - oldsize;
+
+   if(header->site)
+      zone_sites[header->site].liveBytes.fetch_add(delta, std::memory_order_relaxed);
+
+   ZoneUpdatePeak(zone_liveBytes.fetch_add(delta, std::memory_order_relaxed) + delta);
+}
+
+#endif
+
+//=============================================================================
+//
+// Heap Allocation
+//
+// If the system allocator fails, purgeable tagged blocks are released and the
+// request is tried once more before giving up.
+//
+
+static void *ZoneSysMalloc(size_t size)
+{
+   void *ret = std::malloc(size);
+   if(!ret && Z_PurgeCaches())
+      ret = std::malloc(size);
+   return ret;
+}
+
+static void *ZoneSysCalloc(size_t count, size_t size)
+{
+   void *ret = std::calloc(count, size);
+   if(!ret && Z_PurgeCaches())
+      ret = std::calloc(count, size);
+   return ret;
+}
+
+static void *ZoneSysRealloc(void *ptr, size_t size)
+{
+   void *ret = std::realloc(ptr, size);
+   if(!ret && Z_PurgeCaches())
+      ret = std::realloc(ptr, size);
+   return ret;
+}
+
+//
+// Allocate from the heap, bypassing any current arena.
+//
+static void *ZoneHeapMalloc(size_t size, EUNUSED const char *file, EUNUSED int line)
 {
    void *ret;
 
-   if(!(ret = std::malloc(size)))
+#if defined(ELIB_ZONE_STATS)
+   if(!(ret = ZoneSysMalloc(ZONE_HEADERSIZE + size)))
       hal_platform.fatalError("E_Malloc: failed on allocation of %lu bytes", size);
 
+   ret = ZoneRecordAlloc(ret, size, file, line);
+#else
+   if(!(ret = ZoneSysMalloc(size)))
+      hal_platform.fatalError("E_Malloc: failed on allocation of %lu bytes", size);
+#endif
+
    return ret;
 }
 
-void *E_Calloc(size_t count, size_t size)
+//
+// Allocate cleared memory from the heap, bypassing any current arena.
+//
+static void *ZoneHeapCalloc(size_t count, size_t size,
+                            EUNUSED const char *file, EUNUSED int line)
 {
    void *ret;
 
-   if(!(ret = std::calloc(count, size)))
+#if defined(ELIB_ZONE_STATS)
+   const size_t total = count * size;
+   if(size && total / size != count)
+      hal_platform.fatalError("E_Calloc: overflow on allocation of %zu objects", count);
+
+   if(!(ret = ZoneSysCalloc(1, ZONE_HEADERSIZE + total)))
+      hal_platform.fatalError("E_Calloc: failed on allocation of %lu bytes", total);
+
+   ret = ZoneRecordAlloc(ret, total, file, line);
+#else
+   if(!(ret = ZoneSysCalloc(count, size)))
       hal_platform.fatalError("E_Calloc: failed on allocation of %lu bytes", count*size);
+#endif
 
    return ret;
 }
 
-void *E_Realloc(void *ptr, size_t size)
+//
+// Return a block to the heap.
+//
+static void ZoneHeapFree(void *ptr)
+{
+#if defined(ELIB_ZONE_STATS)
+   zoneheader_t *const header = ZoneGetHeader(ptr, "E_Free");
+   ZoneRecordFree(header);
+   header->magic = 0; // catch double frees
+   ptr = header;
+#endif
+
+   std::free(ptr);
+}
+
+//=============================================================================
+//
+// Allocation
+//
+// The "At" variants receive the call site from the allocation macros so that
+// statistics can be attributed; it is ignored in normal builds.
+//
+
+void *E_MallocAt(size_t size, const char *file, int line)
+{
+   if(EArena *const arena = e_currentArena; arena != nullptr)
+      return arena->alloc(size);
+
+   return ZoneHeapMalloc(size, file, line);
+}
+
+void *E_CallocAt(size_t count, size_t size, const char *file, int line)
+{
+   if(EArena *const arena = e_currentArena; arena != nullptr)
+      return arena->calloc(count, size);
+
+   return ZoneHeapCalloc(count, size, file, line);
+}
+
+void *E_ReallocAt(void *ptr, size_t size, EUNUSED const char *file, EUNUSED int line)
 {
    void *ret;
 
-   if(!(ret = std::realloc(ptr, size)))
+   // heap blocks stay on the heap even while an arena is current
+   if(EArena *const arena = e_currentArena; arena != nullptr && (!ptr || arena->owns(ptr)))
+      return arena->realloc(ptr, size);
+
+#if defined(ELIB_ZONE_STATS)
+   if(!ptr)
+      return ZoneHeapMalloc(size, file, line);
+
+   // the block keeps its original call site; only its size changes
+   zoneheader_t *header = ZoneGetHeader(ptr, "E_Realloc");
+   const size_t oldsize = header->size;
+
+   if(!(ret = ZoneSysRealloc(header, ZONE_HEADERSIZE + size)))
+      hal_platform.fatalError("E_Realloc: failed on allocation of %lu bytes", size);
+
+   header = static_cast<zoneheader_t *>(ret);
+   header->size = size;
+   ZoneRecordResize(header, oldsize);
+
+   ret = static_cast<ebyte *>(ret) + ZONE_HEADERSIZE;
+#else
+   if(!(ret = ZoneSysRealloc(ptr, size)))
       hal_platform.fatalError("E_Realloc: failed on allocation of %lu bytes", size);
+#endif
 
    return ret;
 }
 
-char *E_Strdup(const char *str)
+char *E_StrdupAt(const char *str, const char *file, int line)
 {
    char *ret = nullptr;
 
-   if((ret = static_cast<char *>(E_Calloc(1, std::strlen(str) + 1))))
+   if((ret = static_cast<char *>(E_CallocAt(1, std::strlen(str) + 1, file, line))))
       return std::strcpy(ret, str);
 
    return ret;
 }
 
+void *E_Malloc(size_t size)
+{
+   return E_MallocAt(size, nullptr, 0);
+}
+
+void *E_Calloc(size_t count, size_t size)
+{
+   return E_CallocAt(count, size, nullptr, 0);
+}
+
+void *E_Realloc(void *ptr, size_t size)
+{
+   return E_ReallocAt(ptr, size, nullptr, 0);
+}
+
+char *E_Strdup(const char *str)
+{
+   return E_StrdupAt(str, nullptr, 0);
+}
+
 void E_Free(void *ptr)
 {
    if(!ptr)
       hal_platform.fatalError("E_Free: attempt to free null pointer");
 
-   std::free(ptr);
+   // arena memory is only returned in bulk
+   if(EArena *const arena = e_currentArena; arena != nullptr && arena->owns(ptr))
+      return;
+
+   ZoneHeapFree(ptr);
 }
 
-// EOF
+//=============================================================================
+//
+// Tagged Allocation
+//
+// Blocks allocated through Z_Malloc belong to one of the PU_ tags and are
+// kept on a list per tag, oldest first, so that everything with a range of
+// tags can be freed in one sweep. Blocks at or above PU_PURGELEVEL must have
+// an owner pointer; they may be freed at any time the zone needs memory, at
+// which point the owner is set to null. Tagged blocks always come from the
+// heap, even while an arena is current.
+//
 
+static constexpr uint32_t ZONE_TAGMAGIC = 0x5a544147u; // "ZTAG"
+
+struct zoneblock_t
+{
+   EBDListItem<zoneblock_t> links; // link on the list for its tag
+   void   **user;                  // owner pointer, cleared if the block is freed
+   size_t   size;                  // size of the user area
+   int      tag;                   // PU_ tag
+   uint32_t magic;                 // ZONE_TAGMAGIC while the block is live
+};
+
+static constexpr size_t ZONE_BLOCKSIZE =
+   (sizeof(zoneblock_t) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+using zonetaglist_t = EBDList<zoneblock_t, &zoneblock_t::links>;
+
+static std::mutex    zone_tagLock;
+static zonetaglist_t zone_tagLists[PU_MAXTAGS];
+static size_t        zone_tagBytes[PU_MAXTAGS];
+static size_t        zone_tagBlocks[PU_MAXTAGS];
+static size_t        zone_purgeableBytes;
+static size_t        zone_cacheLimit; // 0 for no limit
+
+static inline void *ZoneBlockData(zoneblock_t *block)
+{
+   return reinterpret_cast<ebyte *>(block) + ZONE_BLOCKSIZE;
+}
+
+//
+// Get the block header for a tagged allocation, verifying it.
+//
+static zoneblock_t *ZoneGetBlock(void *ptr, const char *fn)
+{
+   auto block = reinterpret_cast<zoneblock_t *>(static_cast<ebyte *>(ptr) - ZONE_BLOCKSIZE);
+   if(block->magic != ZONE_TAGMAGIC)
+      hal_platform.fatalError("%s: pointer %p is not a tagged zone block", fn, ptr);
+   return block;
+}
+
+static void ZoneCheckTag(int tag, void **user, const char *fn)
+{
+   if(tag <= PU_FREE || tag >= PU_MAXTAGS)
+      hal_platform.fatalError("%s: invalid tag %d", fn, tag);
+   if(tag >= PU_PURGELEVEL && !user)
+      hal_platform.fatalError("%s: purgeable block without an owner", fn);
+}
+
+//
+// Put a block on the list for its tag, as the most recent entry. Called with
+// the tag lock held.
+//
+static void ZoneLinkBlock(zoneblock_t *block)
+{
+   zone_tagLists[block->tag].insert(block);
+   zone_tagBytes[block->tag] += block->size;
+   ++zone_tagBlocks[block->tag];
+   if(block->tag >= PU_PURGELEVEL)
+      zone_purgeableBytes += block->size;
+}
+
+//
+// Take a block off the list for its tag. Called with the tag lock held.
+//
+static void ZoneUnlinkBlock(zoneblock_t *block)
+{
+   zone_tagLists[block->tag].remove(block);
+   zone_tagBytes[block->tag] -= block->size;
+   --zone_tagBlocks[block->tag];
+   if(block->tag >= PU_PURGELEVEL)
+      zone_purgeableBytes -= block->size;
+}
+
+//
+// Clear the owner of an unlinked block and return its memory to the heap.
+// Called with the tag lock held.
+//
+static void ZoneFreeBlock(zoneblock_t *block)
+{
+   if(block->user)
+      *block->user = nullptr;
+
+   block->magic = 0;
+   block->~zoneblock_t();
+   ZoneHeapFree(block);
+}
+
+//
+// Unlink a block, clear its owner, and return its memory to the heap. Called
+// with the tag lock held.
+//
+static void ZoneReleaseBlock(zoneblock_t *block)
+{
+   ZoneUnlinkBlock(block);
+   ZoneFreeBlock(block);
+}
+
+//
+// Free the oldest purgeable blocks until the purgeable total, plus "incoming"
+// bytes about to be added, is within the cache limit. Called with the tag lock
+// held.
+//
+static void ZoneEnforceCacheLimit(size_t incoming = 0)
+{
+   for(int tag = PU_MAXTAGS - 1; tag >= PU_PURGELEVEL; tag--)
+   {
+      while(zone_cacheLimit && zone_purgeableBytes + incoming > zone_cacheLimit &&
+            !zone_tagLists[tag].empty())
+         ZoneReleaseBlock(zone_tagLists[tag].first()->bdObject);
+   }
+}
+
+//
+// Put a new or retagged block on its list. Room is made under the cache limit
+// before the block is linked, so a purge never frees the block itself, even if
+// it alone exceeds the limit. Called with the tag lock held.
+//
+static void ZoneInsertBlock(zoneblock_t *block)
+{
+   if(block->tag >= PU_PURGELEVEL)
+      ZoneEnforceCacheLimit(block->size);
+   ZoneLinkBlock(block);
+}
+
+//
+// Allocate an unlinked tagged block and set its owner.
+//
+static zoneblock_t *ZoneNewBlock(size_t size, int tag, void **user)
+{
+   auto block = new (ZoneHeapMalloc(ZONE_BLOCKSIZE + size, nullptr, 0)) zoneblock_t;
+   block->user  = user;
+   block->size  = size;
+   block->tag   = tag;
+   block->magic = ZONE_TAGMAGIC;
+
+   if(user)
+      *user = ZoneBlockData(block);
+
+   return block;
+}
+
+//
+// Allocate a tagged block. If user is not null, *user receives the pointer,
+// and is cleared again whenever the block is freed by any means.
+//
+void *Z_Malloc(size_t size, int tag, void **user)
+{
+   ZoneCheckTag(tag, user, "Z_Malloc");
+
+   zoneblock_t *const block = ZoneNewBlock(size, tag, user);
+
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+   ZoneInsertBlock(block);
+
+   return ZoneBlockData(block);
+}
+
+//
+// Allocate a cleared tagged block.
+//
+void *Z_Calloc(size_t count, size_t size, int tag, void **user)
+{
+   const size_t total = count * size;
+   if(size && total / size != count)
+      hal_platform.fatalError("Z_Calloc: overflow on allocation of %zu objects", count);
+
+   return std::memset(Z_Malloc(total, tag, user), 0, total);
+}
+
+//
+// Resize a tagged block. The block is moved to the given tag and owner.
+//
+void *Z_Realloc(void *ptr, size_t size, int tag, void **user)
+{
+   if(!ptr)
+      return Z_Malloc(size, tag, user);
+
+   ZoneCheckTag(tag, user, "Z_Realloc");
+
+   zoneblock_t *const oldblock = ZoneGetBlock(ptr, "Z_Realloc");
+
+   // take the old block off its list so that neither the cache limit nor a
+   // purge on heap exhaustion can free it while it is being copied
+   {
+      std::lock_guard<std::mutex> guard(zone_tagLock);
+      ZoneUnlinkBlock(oldblock);
+   }
+
+   zoneblock_t *const block = ZoneNewBlock(size, tag, user);
+   std::memcpy(ZoneBlockData(block), ptr, emin(size, oldblock->size));
+
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+
+   // the old owner must not be cleared if it is also the new owner
+   if(oldblock->user == user)
+      oldblock->user = nullptr;
+   ZoneFreeBlock(oldblock);
+   ZoneInsertBlock(block);
+
+   return ZoneBlockData(block);
+}
+
+//
+// Duplicate a string into a tagged block.
+//
+char *Z_Strdup(const char *str, int tag, void **user)
+{
+   const size_t len = std::strlen(str) + 1;
+   return static_cast<char *>(std::memcpy(Z_Malloc(len, tag, user), str, len));
+}
+
+//
+// Free a single tagged block.
+//
+void Z_Free(void *ptr)
+{
+   if(!ptr)
+      hal_platform.fatalError("Z_Free: attempt to free null pointer");
+
+   zoneblock_t *const block = ZoneGetBlock(ptr, "Z_Free");
+
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+   ZoneReleaseBlock(block);
+}
+
+//
+// Free every tagged block with a tag in [lowtag, hightag].
+//
+void Z_FreeTags(int lowtag, int hightag)
+{
+   lowtag  = emax(lowtag,  int(PU_FREE + 1));
+   hightag = emin(hightag, int(PU_MAXTAGS - 1));
+
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+   for(int tag = lowtag; tag <= hightag; tag++)
+   {
+      while(!zone_tagLists[tag].empty())
+         ZoneReleaseBlock(zone_tagLists[tag].first()->bdObject);
+   }
+}
+
+//
+// Move a block to a different tag. It becomes the most recent block on the
+// new tag's list, so changing a purgeable block to its own tag marks it as
+// recently used.
+//
+void Z_ChangeTag(void *ptr, int tag)
+{
+   zoneblock_t *const block = ZoneGetBlock(ptr, "Z_ChangeTag");
+   ZoneCheckTag(tag, block->user, "Z_ChangeTag");
+
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+   ZoneUnlinkBlock(block);
+   block->tag = tag;
+   ZoneInsertBlock(block);
+}
+
+//
+// Change the owner pointer of a block.
+//
+void Z_ChangeUser(void *ptr, void **user)
+{
+   zoneblock_t *const block = ZoneGetBlock(ptr, "Z_ChangeUser");
+
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+   if(!user && block->tag >= PU_PURGELEVEL)
+      hal_platform.fatalError("Z_ChangeUser: purgeable block without an owner");
+   block->user = user;
+   if(user)
+      *user = ptr;
+}
+
+//
+// Free all purgeable blocks. Returns nonzero if any memory was released.
+//
+int Z_PurgeCaches(void)
+{
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+
+   int released = 0;
+   for(int tag = PU_PURGELEVEL; tag < PU_MAXTAGS; tag++)
+   {
+      while(!zone_tagLists[tag].empty())
+      {
+         ZoneReleaseBlock(zone_tagLists[tag].first()->bdObject);
+         released = 1;
+      }
+   }
+
+   return released;
+}
+
+//
+// Limit the total size of purgeable blocks. When it is exceeded, the least
+// recently allocated or touched purgeable blocks are freed. 0 removes the limit.
+//
+void Z_SetCacheLimit(size_t bytes)
+{
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+   zone_cacheLimit = bytes;
+   ZoneEnforceCacheLimit();
+}
+
+//
+// Get the total bytes and number of blocks currently held under a tag.
+//
+size_t Z_TagUsage(int tag, size_t *blocks)
+{
+   if(tag <= PU_FREE || tag >= PU_MAXTAGS)
+   {
+      if(blocks)
+         *blocks = 0;
+      return 0;
+   }
+
+   std::lock_guard<std::mutex> guard(zone_tagLock);
+   if(blocks)
+      *blocks = zone_tagBlocks[tag];
+   return zone_tagBytes[tag];
+}
+
+//=============================================================================
+//
+// Statistics Reporting
+//
+
+//
+// Set how often allocations are attributed to their call site: one in every
+// "rate" allocations per thread. A rate of 1 attributes every allocation.
+//
+void Z_SetStatsSampleRate(EUNUSED unsigned int rate)
+{
+#if defined(ELIB_ZONE_STATS)
+   zone_sampleRate.store(rate ? rate : 1, std::memory_order_relaxed);
+#endif
+}
+
+//
+// Take a snapshot of the global counters. All zero if statistics are not
+// compiled in.
+//
+void Z_GetStats(zonestats_t *stats)
+{
+   std::memset(stats, 0, sizeof(*stats));
+
+#if defined(ELIB_ZONE_STATS)
+   stats->liveBytes  = zone_liveBytes.load(std::memory_order_relaxed);
+   stats->peakBytes  = zone_peakBytes.load(std::memory_order_relaxed);
+   stats->liveBlocks = zone_liveBlocks.load(std::memory_order_relaxed);
+   stats->allocCount = zone_allocCount.load(std::memory_order_relaxed);
+   stats->freeCount  = zone_freeCount.load(std::memory_order_relaxed);
+   for(size_t i = 0; i < ZONE_NUMHISTBUCKETS; i++)
+      stats->histogram[i] = zone_histogram[i].load(std::memory_order_relaxed);
+#endif
+}
+
+#if defined(ELIB_ZONE_STATS)
+
+struct zonesitereport_t
+{
+   const char *file;
+   int         line;
+   size_t      liveBytes;
+   size_t      liveBlocks;
+   size_t      allocs;
+};
+
+//
+// Print sampled call sites, largest live byte count first. If leaksOnly is
+// set, sites with nothing outstanding are skipped.
+//
+static void ZoneDumpSites(bool leaksOnly)
+{
+   std::vector<zonesitereport_t> report;
+   size_t attributed = 0;
+
+   for(size_t i = 1; i < ZONE_MAXSITES; i++)
+   {
+      const zonesite_t &site = zone_sites[i];
+      const char *const file = site.file.load(std::memory_order_acquire);
+      if(!file)
+         continue;
+
+      const zonesitereport_t entry =
+      {
+         file, site.line,
+         site.liveBytes.load(std::memory_order_relaxed),
+         site.liveBlocks.load(std::memory_order_relaxed),
+         site.allocs.load(std::memory_order_relaxed)
+      };
+      attributed += entry.liveBytes;
+
+      if(!leaksOnly || entry.liveBlocks)
+         report.push_back(entry);
+   }
+
+   std::sort(report.begin(), report.end(), [] (const zonesitereport_t &a, const zonesitereport_t &b) {
+      return a.liveBytes > b.liveBytes;
+   });
+
+   for(const zonesitereport_t &entry : report)
+   {
+      hal_platform.debugMsg("  %s:%d: %zu bytes live in %zu blocks (%zu sampled allocations)\n",
+                            entry.file, entry.line, entry.liveBytes, entry.liveBlocks, entry.allocs);
+   }
+
+   const size_t live = zone_liveBytes.load(std::memory_order_relaxed);
+   if(live > attributed)
+      hal_platform.debugMsg("  (unattributed): %zu bytes live\n", live - attributed);
+}
+
+#endif
+
+//
+// Print usage by tag, and if statistics are compiled in, the global counters,
+// size histogram and per-call-site breakdown.
+//
+void Z_DumpStats(void)
+{
+   static const char *const tagNames[PU_MAXTAGS] =
+   {
+      "PU_FREE", "PU_STATIC", "PU_PARSER", "PU_LEVEL", "PU_CACHE"
+   };
+
+   hal_platform.debugMsg("Tagged blocks:\n");
+   for(int tag = PU_STATIC; tag < PU_MAXTAGS; tag++)
+   {
+      size_t blocks;
+      const size_t bytes = Z_TagUsage(tag, &blocks);
+      hal_platform.debugMsg("  %-10s %zu bytes in %zu blocks\n", tagNames[tag], bytes, blocks);
+   }
+
+#if defined(ELIB_ZONE_STATS)
+   zonestats_t stats;
+   Z_GetStats(&stats);
+
+   hal_platform.debugMsg("Zone statistics:\n");
+   hal_platform.debugMsg("  %zu bytes live in %zu blocks, peak %zu bytes\n",
+                         stats.liveBytes, stats.liveBlocks, stats.peakBytes);
+   hal_platform.debugMsg("  %zu allocations, %zu frees\n", stats.allocCount, stats.freeCount);
+
+   hal_platform.debugMsg("Allocations by size:\n");
+   for(size_t i = 0; i < ZONE_NUMHISTBUCKETS; i++)
+   {
+      if(stats.histogram[i])
+         hal_platform.debugMsg("  < %zu bytes: %zu\n", size_t(1) << i, stats.histogram[i]);
+   }
+
+   hal_platform.debugMsg("Live memory by call site (1 in %u sampled):\n",
+                         zone_sampleRate.load(std::memory_order_relaxed));
+   ZoneDumpSites(false);
+#else
+   hal_platform.debugMsg("Zone statistics are not enabled in this build\n");
+#endif
+}
+
+//
+// Print every sampled call site that still has memory outstanding.
+//
+void Z_DumpLeaks(void)
+{
+#if defined(ELIB_ZONE_STATS)
+   if(!zone_liveBlocks.load(std::memory_order_relaxed))
+      return;
+
+   hal_platform.debugMsg("Zone blocks outstanding at exit:\n");
+   ZoneDumpSites(true);
+#endif
+}
+
+//
+// Schedule the leak listing to run from E_RunAtExitFuncs. Since exit functions
+// run in reverse order of registration, call this before anything else
+// registers with E_AtExit so that the listing runs last.
+//
+void Z_InitStats(void)
+{
+#if defined(ELIB_ZONE_STATS)
+   E_AtExit(Z_DumpLeaks, true);
+#endif
+}
+
+// EOF
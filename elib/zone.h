@@ -38,15 +38,82 @@ void *E_Realloc(void *ptr, size_t size);
 char *E_Strdup(const char *str);
 void  E_Free(void *ptr);
 
+// Call-site variants used by the allocation macros
+void *E_MallocAt(size_t size, const char *file, int line);
+void *E_CallocAt(size_t count, size_t size, const char *file, int line);
+void *E_ReallocAt(void *ptr, size_t size, const char *file, int line);
+char *E_StrdupAt(const char *str, const char *file, int line);
+
+//
+// Tagged allocation. Every block belongs to a tag, and all blocks with a
+// range of tags can be freed at once. Blocks at or above PU_PURGELEVEL must
+// have an owner pointer and may be freed whenever memory is short; the owner
+// is set to null when that happens.
+//
+
+enum
+{
+   PU_FREE,       // (internal) block is free
+   PU_STATIC,     // static for the entire execution
+   PU_PARSER,     // data built while parsing, freed when the parse is done
+   PU_LEVEL,      // data for the current level or session
+   PU_PURGELEVEL, // tags at or above this level are purgeable
+   PU_CACHE = PU_PURGELEVEL,
+   PU_MAXTAGS
+};
+
+void  *Z_Malloc(size_t size, int tag, void **user);
+void  *Z_Calloc(size_t count, size_t size, int tag, void **user);
+void  *Z_Realloc(void *ptr, size_t size, int tag, void **user);
+char  *Z_Strdup(const char *str, int tag, void **user);
+void   Z_Free(void *ptr);
+void   Z_FreeTags(int lowtag, int hightag);
+void   Z_ChangeTag(void *ptr, int tag);
+void   Z_ChangeUser(void *ptr, void **user);
+int    Z_PurgeCaches(void);
+void   Z_SetCacheLimit(size_t bytes);
+size_t Z_TagUsage(int tag, size_t *blocks);
+
+//
+// Allocation statistics. These are only gathered in builds which define
+// ELIB_ZONE_STATS; otherwise the functions below report nothing.
+//
+
+#define ZONE_NUMHISTBUCKETS 32
+
+typedef struct zonestats_s
+{
+   size_t liveBytes;   // bytes currently allocated
+   size_t peakBytes;   // high-water mark of liveBytes
+   size_t liveBlocks;  // blocks currently allocated
+   size_t allocCount;  // total allocations made
+   size_t freeCount;   // total blocks freed
+   size_t histogram[ZONE_NUMHISTBUCKETS]; // allocations by size; bucket n holds [2^(n-1), 2^n)
+} zonestats_t;
+
+void Z_GetStats(zonestats_t *stats);
+void Z_SetStatsSampleRate(unsigned int rate);
+void Z_DumpStats(void);
+void Z_DumpLeaks(void);
+void Z_InitStats(void);
+
 #ifdef __cplusplus
 }
 #endif
 
+#if defined(ELIB_ZONE_STATS)
+#define ecalloc(type, count, size) (type *)(E_CallocAt(count, size, __FILE__, __LINE__))
+#define emalloc(type, size)        (type *)(E_MallocAt(size, __FILE__, __LINE__))
+#define erealloc(type, ptr, size)  (type *)(E_ReallocAt(ptr, size, __FILE__, __LINE__))
+#define estructalloc(type, num)    (type *)(E_CallocAt(num, sizeof(type), __FILE__, __LINE__))
+#define estrdup(str)               E_StrdupAt(str, __FILE__, __LINE__)
+#else
 #define ecalloc(type, count, size) (type *)(E_Calloc(count, size))
 #define emalloc(type, size)        (type *)(E_Malloc(size))
 #define erealloc(type, ptr, size)  (type *)(E_Realloc(ptr, size))
 #define estructalloc(type, num)    (type *)(E_Calloc(num, sizeof(type)))
 #define estrdup(str)               E_Strdup(str)
+#endif
 #define efree(ptr)                 E_Free(ptr)
 
 // EOF
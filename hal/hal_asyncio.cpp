@@ -0,0 +1,280 @@
+/*
+  ELib
+
+  Asynchronous file I/O
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <limits.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../elib/elib.h"
+#include "hal_asyncio.h"
+#include "hal_platform.h"
+
+//=============================================================================
+//
+// Default implementation - a pool of threads doing blocking stdio through
+// hal_platform.fileOpen. Platforms with a true asynchronous interface
+// install their own.
+//
+//=============================================================================
+
+//
+// Seek to a 64-bit offset.
+//
+static bool HAL_FileSeek(FILE *f, uint64_t offset)
+{
+#if defined(_MSC_VER)
+    return _fseeki64(f, int64_t(offset), SEEK_SET) == 0;
+#elif defined(__unix__) || defined(__linux__) || defined(__APPLE__)
+    return fseeko(f, off_t(offset), SEEK_SET) == 0;
+#else
+    return offset <= uint64_t(LONG_MAX) && fseek(f, long(offset), SEEK_SET) == 0;
+#endif
+}
+
+//
+// Size of an open file, or -1 on error.
+//
+static int64_t HAL_FileSize(FILE *f)
+{
+#if defined(_MSC_VER)
+    if(_fseeki64(f, 0, SEEK_END))
+        return -1;
+    return _ftelli64(f);
+#elif defined(__unix__) || defined(__linux__) || defined(__APPLE__)
+    if(fseeko(f, 0, SEEK_END))
+        return -1;
+    return int64_t(ftello(f));
+#else
+    if(fseek(f, 0, SEEK_END))
+        return -1;
+    return int64_t(ftell(f));
+#endif
+}
+
+//
+// Carry out a request on the calling thread.
+//
+static void HAL_PerformIO(hal_iorequest_t *req)
+{
+    static const char *const modes[] = { "rb", "rb", "r+b", "wb" };
+
+    req->error       = 0;
+    req->transferred = 0;
+
+    errno = 0;
+    FILE *f = hal_platform.fileOpen(req->path, modes[req->op]);
+    if(!f && req->op == HAL_IO_WRITE && errno == ENOENT)
+        f = hal_platform.fileOpen(req->path, "w+b");
+    if(!f)
+    {
+        req->error = errno ? errno : EIO;
+        return;
+    }
+
+    switch(req->op)
+    {
+    case HAL_IO_READFILE:
+    {
+        const int64_t size = HAL_FileSize(f);
+        if(size < 0 || uint64_t(size) >= SIZE_MAX || !HAL_FileSeek(f, 0))
+        {
+            req->error = EIO;
+            break;
+        }
+        // terminated, so that text can be parsed in place
+        ebyte *const buffer = emalloc(ebyte, size_t(size) + 1);
+        req->transferred = std::fread(buffer, 1, size_t(size), f);
+        buffer[req->transferred] = 0;
+        req->buffer = buffer;
+        req->size   = req->transferred;
+        if(std::ferror(f))
+            req->error = EIO;
+        break;
+    }
+    case HAL_IO_READ:
+        if(!HAL_FileSeek(f, req->offset))
+            req->error = EINVAL;
+        else
+        {
+            req->transferred = std::fread(req->buffer, 1, req->size, f);
+            if(std::ferror(f))
+                req->error = EIO;
+        }
+        break;
+    case HAL_IO_WRITE:
+        if(!HAL_FileSeek(f, req->offset))
+        {
+            req->error = EINVAL;
+            break;
+        }
+        // fall through
+    case HAL_IO_WRITEFILE:
+        req->transferred = std::fwrite(req->buffer, 1, req->size, f);
+        if(req->transferred != req->size)
+            req->error = EIO;
+        break;
+    }
+
+    if(std::fclose(f) && !req->error)
+        req->error = EIO;
+}
+
+class HALIOPool
+{
+public:
+    ~HALIOPool()
+    {
+        {
+            std::lock_guard lock(m_lock);
+            m_stopping = true;
+        }
+        m_work.notify_all();
+        for(std::thread &thread : m_threads)
+            thread.join();
+    }
+
+    void submit(hal_iorequest_t **requests, size_t count)
+    {
+        {
+            std::lock_guard lock(m_lock);
+            if(m_threads.empty())
+                start();
+            for(size_t i = 0; i < count; i++)
+                m_queues[eclamp<int>(requests[i]->priority, 0, HAL_IOPRI_COUNT - 1)].push_back(requests[i]);
+            m_outstanding += count;
+        }
+        if(count > 1)
+            m_work.notify_all();
+        else
+            m_work.notify_one();
+    }
+
+    void drain()
+    {
+        std::unique_lock lock(m_lock);
+        m_idle.wait(lock, [this] { return m_outstanding == 0; });
+    }
+
+private:
+    std::mutex                   m_lock;
+    std::condition_variable      m_work;
+    std::condition_variable      m_idle;
+    std::deque<hal_iorequest_t*> m_queues[HAL_IOPRI_COUNT];
+    std::vector<std::thread>     m_threads;
+    size_t                       m_outstanding = 0;
+    bool                         m_stopping    = false;
+
+    //
+    // Threads are started on first use. A few suffice to keep a disk busy;
+    // more would mostly contend for it.
+    //
+    void start()
+    {
+        const unsigned int numThreads = eclamp(std::thread::hardware_concurrency(), 2u, 4u);
+        for(unsigned int i = 0; i < numThreads; i++)
+            m_threads.emplace_back(&HALIOPool::worker, this);
+    }
+
+    hal_iorequest_t *next()
+    {
+        for(int priority = HAL_IOPRI_COUNT - 1; priority >= 0; priority--)
+        {
+            if(!m_queues[priority].empty())
+            {
+                hal_iorequest_t *const req = m_queues[priority].front();
+                m_queues[priority].pop_front();
+                return req;
+            }
+        }
+        return nullptr;
+    }
+
+    //
+    // Finish every queued request, even when stopping, so none is left
+    // without its callback.
+    //
+    void worker()
+    {
+        std::unique_lock lock(m_lock);
+        for(;;)
+        {
+            hal_iorequest_t *const req = next();
+            if(!req)
+            {
+                if(m_stopping)
+                    return;
+                m_work.wait(lock);
+                continue;
+            }
+
+            lock.unlock();
+            HAL_PerformIO(req);
+            if(req->callback)
+                req->callback(req);
+            lock.lock();
+
+            if(!--m_outstanding)
+                m_idle.notify_all();
+        }
+    }
+};
+
+static HALIOPool &HAL_IOPool()
+{
+    static HALIOPool pool;
+    return pool;
+}
+
+static void HAL_SubmitIO(hal_iorequest_t **requests, size_t count)
+{
+    HAL_IOPool().submit(requests, count);
+}
+
+static void HAL_DrainIO()
+{
+    HAL_IOPool().drain();
+}
+
+static const char *HAL_IOBackend()
+{
+    return "thread pool";
+}
+
+// global singleton
+hal_asyncio_t hal_asyncio =
+{
+    HAL_SubmitIO,
+    HAL_DrainIO,
+    HAL_IOBackend
+};
+
+// EOF
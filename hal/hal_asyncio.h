@@ -0,0 +1,102 @@
+/*
+  ELib
+
+  Asynchronous file I/O
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hal_types.h"
+
+typedef enum hal_ioop_e
+{
+    HAL_IO_READ,      // read size bytes at offset into buffer
+    HAL_IO_READFILE,  // read the whole file into a new buffer
+    HAL_IO_WRITE,     // write size bytes from buffer at offset, creating the file
+    HAL_IO_WRITEFILE  // replace the file's contents with size bytes from buffer
+} hal_ioop;
+
+typedef enum hal_iopriority_e
+{
+    HAL_IOPRI_LOW,
+    HAL_IOPRI_NORMAL,
+    HAL_IOPRI_HIGH,
+    HAL_IOPRI_COUNT
+} hal_iopriority;
+
+typedef struct hal_iorequest_s hal_iorequest_t;
+
+//
+// A file operation. The request, its path, and its buffer belong to the
+// caller and must stay valid until the callback has been made.
+//
+struct hal_iorequest_s
+{
+    // set by the caller
+    hal_ioop        op;
+    hal_iopriority  priority;
+    const char     *path;
+    uint64_t        offset;
+    void           *buffer;   // HAL_IO_READFILE: set to an emalloc'd buffer
+    size_t          size;     // HAL_IO_READFILE: set to the file's size
+
+    // Called once when the request is done, on a thread of the I/O service,
+    // if set. It should be brief, since it holds up other completions.
+    void          (*callback)(hal_iorequest_t *request);
+    void           *userdata;
+
+    // set by the service before the callback
+    int             error;       // 0, or an errno value
+    size_t          transferred; // bytes read or written; reads stop early at end of file
+};
+
+typedef struct hal_asyncio_s
+{
+    // Queue a batch of requests. Higher priorities are started first, and
+    // each priority in order of submission.
+    void        (*submit)(hal_iorequest_t **requests, size_t count);
+
+    // Wait until every request submitted so far has made its callback.
+    // Must not be called from a callback.
+    void        (*drain)(void);
+
+    // Name of the implementation, for diagnostics
+    const char *(*backend)(void);
+} hal_asyncio_t;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+extern hal_asyncio_t hal_asyncio;
+
+#if defined(__cplusplus)
+}
+#endif
+
+// EOF
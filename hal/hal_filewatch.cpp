@@ -0,0 +1,59 @@
+/*
+  ELib
+
+  HAL File Change Notification
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "hal_filewatch.h"
+
+//=============================================================================
+// 
+// Default implementation - this is do-nothing.
+//
+//=============================================================================
+
+static struct hal_watch_t *HAL_WatchFile(const char *)
+{
+    return nullptr;
+}
+
+static hal_bool HAL_FileChanged(struct hal_watch_t *)
+{
+    return HAL_FALSE;
+}
+
+static void HAL_CloseWatch(struct hal_watch_t *)
+{
+}
+
+// global singleton
+hal_filewatch_t hal_filewatch =
+{
+    HAL_WatchFile,
+    HAL_FileChanged,
+    HAL_CloseWatch
+};
+
+// EOF
@@ -0,0 +1,58 @@
+/*
+  ELib
+
+  HAL File Change Notification
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "hal_types.h"
+
+// hal_watch_t is an opaque handle on a watched file
+struct hal_watch_t;
+
+typedef struct hal_filewatch_s
+{
+    // Begin watching a file, which need not exist yet; nullptr if unsupported
+    struct hal_watch_t *(*watchFile)(const char *path);
+
+    // Non-blocking; true if the file was changed, created, replaced or removed
+    // since the watch began or since the last call that returned true
+    hal_bool            (*fileChanged)(struct hal_watch_t *watch);
+
+    void                (*closeWatch)(struct hal_watch_t *watch);
+} hal_filewatch_t;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+extern hal_filewatch_t hal_filewatch;
+
+#if defined(__cplusplus)
+}
+#endif
+
+// EOF
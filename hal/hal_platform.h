@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <stdio.h>
 #include "hal_types.h"
 
@@ -41,6 +42,20 @@ typedef struct hal_platform_s
    hal_bool    (*fileExists)(const char *path);
    hal_bool    (*directoryExists)(const char *path);
    hal_bool    (*makeDirectory)(const char *path);
+
+   // Map a file read-only into memory. Returns nullptr on failure, including
+   // for empty files. On success *size receives the file length, and
+   // *terminated is set if a zero byte is guaranteed to follow the data.
+   const void *(*mapFile)(const char *path, size_t *size, hal_bool *terminated);
+   void        (*unmapFile)(const void *data, size_t size);
+
+   // Size and last modification time, in nanoseconds from an unspecified
+   // epoch, of a regular file.
+   hal_bool    (*fileStat)(const char *path, uint64_t *size, int64_t *mtime);
+
+   // Replace a file's contents so that, even across a crash, it holds either
+   // the old contents or all of the new ones, never neither
+   hal_bool    (*writeFileAtomic)(const char *path, const void *data, size_t size);
 } hal_platform_t;
 
 #if defined(__cplusplus)
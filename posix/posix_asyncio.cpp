@@ -0,0 +1,525 @@
+/*
+  ELib
+
+  POSIX asynchronous file I/O
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__unix__) || defined(__linux__) || defined(__APPLE__)
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ELIB_IO_URING
+#endif
+
+#if defined(ELIB_IO_URING)
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../elib/elib.h"
+#include "../hal/hal_asyncio.h"
+#include "posix_asyncio.h"
+
+#if defined(ELIB_IO_URING)
+
+//=============================================================================
+//
+// Linux io_uring Implementation
+//
+// Requests are carried through a single ring, driven with the raw system
+// calls so as not to need liburing. Each request in flight passes through
+// opening, one or more transfers, and closing; the kernel does the opening
+// and transfers, and one completion thread reaps their results, submits the
+// next step, and makes the callbacks. Requests beyond the ring's capacity
+// wait in queues by priority.
+//
+//=============================================================================
+
+static int POSIX_IOUringSetup(unsigned int entries, io_uring_params *params)
+{
+    return int(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int POSIX_IOUringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags)
+{
+    return int(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static int POSIX_IOUringRegister(int fd, unsigned int opcode, void *arg, unsigned int count)
+{
+    return int(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+static bool POSIX_IsWrite(const hal_iorequest_t *req)
+{
+    return req->op == HAL_IO_WRITE || req->op == HAL_IO_WRITEFILE;
+}
+
+//
+// A request in flight.
+//
+struct posixioop_t : public EPoolAllocated
+{
+    hal_iorequest_t *req;
+    int              fd   = -1;
+    size_t           size = 0;    // bytes to transfer in all
+};
+
+class POSIXIOUring
+{
+public:
+    static constexpr unsigned int ENTRIES = 64;
+
+    ~POSIXIOUring();
+
+    bool init();
+    void submit(hal_iorequest_t **requests, size_t count);
+    void drain();
+
+private:
+    int             m_fd = -1;
+
+    // submission ring
+    void           *m_sqRing     = nullptr;
+    size_t          m_sqRingSize = 0;
+    unsigned int   *m_sqTail     = nullptr;
+    unsigned int    m_sqMask     = 0;
+    unsigned int   *m_sqArray    = nullptr;
+    io_uring_sqe   *m_sqes       = nullptr;
+    size_t          m_sqesSize   = 0;
+    unsigned int    m_sqPending  = 0;    // filled in but not yet entered
+
+    // completion ring, which may share the submission ring's mapping
+    void           *m_cqRing     = nullptr;
+    size_t          m_cqRingSize = 0;
+    unsigned int   *m_cqHead     = nullptr;
+    unsigned int   *m_cqTail     = nullptr;
+    unsigned int    m_cqMask     = 0;
+    io_uring_cqe   *m_cqes       = nullptr;
+
+    std::mutex                   m_lock;      // guards all below and the submission ring
+    std::condition_variable      m_idle;
+    std::deque<hal_iorequest_t*> m_queues[HAL_IOPRI_COUNT];
+    unsigned int                 m_active      = 0;  // ops in the ring
+    size_t                       m_outstanding = 0;  // ops in the ring or queued
+    bool                         m_stopping    = false;
+    std::thread                  m_reaper;
+
+    io_uring_sqe *getSQE();
+    void          enter();
+    void          pump();
+    void          open(posixioop_t *op);
+    bool          transfer(posixioop_t *op);
+    void          finish(posixioop_t *op, int error);
+    void          complete(posixioop_t *op, int res);
+    void          reaper();
+};
+
+//
+// Create the ring, and check that the kernel has the operations used.
+//
+bool POSIXIOUring::init()
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    if((m_fd = POSIX_IOUringSetup(ENTRIES, &params)) < 0)
+        return false;
+
+    {
+        const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+        EUniquePtr<io_uring_probe> probe(static_cast<io_uring_probe *>(ecalloc(void, 1, probeSize)));
+        if(POSIX_IOUringRegister(m_fd, IORING_REGISTER_PROBE, probe.get(), 256) < 0)
+            return false;
+        for(const int opcode : { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_NOP })
+        {
+            if(opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+    }
+
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    m_cqRingSize = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+    if(params.features & IORING_FEAT_SINGLE_MMAP)
+        m_sqRingSize = m_cqRingSize = emax(m_sqRingSize, m_cqRingSize);
+
+    void *const sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              m_fd, IORING_OFF_SQ_RING);
+    if(sqRing == MAP_FAILED)
+        return false;
+    m_sqRing = sqRing;
+
+    if(params.features & IORING_FEAT_SINGLE_MMAP)
+        m_cqRing = m_sqRing;
+    else
+    {
+        void *const cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  m_fd, IORING_OFF_CQ_RING);
+        if(cqRing == MAP_FAILED)
+            return false;
+        m_cqRing = cqRing;
+    }
+
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *const sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            m_fd, IORING_OFF_SQES);
+    if(sqes == MAP_FAILED)
+        return false;
+    m_sqes = static_cast<io_uring_sqe *>(sqes);
+
+    ebyte *const sq = static_cast<ebyte *>(m_sqRing);
+    ebyte *const cq = static_cast<ebyte *>(m_cqRing);
+    m_sqTail  = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+    m_sqMask  = *reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+    m_sqArray = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+    m_cqHead  = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+    m_cqTail  = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+    m_cqMask  = *reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+    m_cqes    = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    m_reaper = std::thread(&POSIXIOUring::reaper, this);
+    return true;
+}
+
+//
+// Finish what was submitted, then stop the reaper with a final no-op.
+//
+POSIXIOUring::~POSIXIOUring()
+{
+    if(m_reaper.joinable())
+    {
+        drain();
+        {
+            std::lock_guard lock(m_lock);
+            m_stopping = true;
+            io_uring_sqe *const sqe = getSQE();
+            sqe->opcode = IORING_OP_NOP;
+            enter();
+        }
+        m_reaper.join();
+    }
+
+    if(m_sqes)
+        munmap(m_sqes, m_sqesSize);
+    if(m_cqRing && m_cqRing != m_sqRing)
+        munmap(m_cqRing, m_cqRingSize);
+    if(m_sqRing)
+        munmap(m_sqRing, m_sqRingSize);
+    if(m_fd >= 0)
+        close(m_fd);
+}
+
+//
+// Next free submission entry, cleared. There is always one, as each op has
+// at most one entry outstanding and at most ENTRIES ops are active; the
+// no-op that stops the reaper is sent only once all are done.
+//
+io_uring_sqe *POSIXIOUring::getSQE()
+{
+    const unsigned int tail  = *m_sqTail + m_sqPending++;
+    const unsigned int index = tail & m_sqMask;
+
+    io_uring_sqe *const sqe = &m_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    m_sqArray[index] = index;
+    return sqe;
+}
+
+//
+// Publish the entries filled in since last time, and hand them to the kernel.
+//
+void POSIXIOUring::enter()
+{
+    if(!m_sqPending)
+        return;
+
+    const unsigned int count = m_sqPending;
+    __atomic_store_n(m_sqTail, *m_sqTail + count, __ATOMIC_RELEASE);
+    m_sqPending = 0;
+
+    for(unsigned int submitted = 0; submitted < count; )
+    {
+        const int res = POSIX_IOUringEnter(m_fd, count - submitted, 0, 0);
+        if(res > 0)
+            submitted += unsigned(res);
+        else if(res < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            hal_platform.fatalError("POSIXIOUring::enter: io_uring_enter failed (%d)", errno);
+    }
+}
+
+//
+// Start queued requests while the ring has room, highest priority first.
+//
+void POSIXIOUring::pump()
+{
+    for(int priority = HAL_IOPRI_COUNT - 1; priority >= 0 && m_active < ENTRIES; priority--)
+    {
+        std::deque<hal_iorequest_t*> &queue = m_queues[priority];
+        while(!queue.empty() && m_active < ENTRIES)
+        {
+            posixioop_t *const op = new posixioop_t;
+            op->req = queue.front();
+            queue.pop_front();
+            ++m_active;
+            open(op);
+        }
+    }
+}
+
+void POSIXIOUring::open(posixioop_t *op)
+{
+    static constexpr int flags[] =
+    {
+        O_RDONLY,                    // HAL_IO_READ
+        O_RDONLY,                    // HAL_IO_READFILE
+        O_WRONLY | O_CREAT,          // HAL_IO_WRITE
+        O_WRONLY | O_CREAT | O_TRUNC // HAL_IO_WRITEFILE
+    };
+
+    hal_iorequest_t *const req = op->req;
+    req->error       = 0;
+    req->transferred = 0;
+    if(req->op != HAL_IO_READFILE)
+        op->size = req->size;
+
+    io_uring_sqe *const sqe = getSQE();
+    sqe->opcode     = IORING_OP_OPENAT;
+    sqe->fd         = AT_FDCWD;
+    sqe->addr       = reinterpret_cast<uintptr_t>(req->path);
+    sqe->len        = 0666;
+    sqe->open_flags = unsigned(flags[req->op] | O_CLOEXEC);
+    sqe->user_data  = reinterpret_cast<uintptr_t>(op);
+}
+
+//
+// Submit the next read or write for an open file. Returns false once there
+// is nothing left to transfer.
+//
+bool POSIXIOUring::transfer(posixioop_t *op)
+{
+    hal_iorequest_t *const req = op->req;
+    if(req->transferred >= op->size)
+        return false;
+
+    // best-effort class, at levels 0 (highest), 4 (the default), and 7
+    static constexpr unsigned int ioprio[HAL_IOPRI_COUNT] = { (2 << 13) | 7, (2 << 13) | 4, (2 << 13) | 0 };
+
+    const bool   isRead = !POSIX_IsWrite(req);
+    const size_t len    = emin<size_t>(op->size - req->transferred, 1u << 30);
+
+    io_uring_sqe *const sqe = getSQE();
+    sqe->opcode    = isRead ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe->fd        = op->fd;
+    sqe->ioprio    = uint16_t(ioprio[eclamp<int>(req->priority, 0, HAL_IOPRI_COUNT - 1)]);
+    sqe->addr      = reinterpret_cast<uintptr_t>(static_cast<ebyte *>(req->buffer) + req->transferred);
+    sqe->len       = unsigned(len);
+    sqe->off       = (req->op == HAL_IO_READFILE || req->op == HAL_IO_WRITEFILE ? 0 : req->offset) + req->transferred;
+    sqe->user_data = reinterpret_cast<uintptr_t>(op);
+    return true;
+}
+
+//
+// Close the file, make the callback, and free the op's slot for the queue.
+//
+void POSIXIOUring::finish(posixioop_t *op, int error)
+{
+    hal_iorequest_t *const req = op->req;
+    if(op->fd >= 0 && close(op->fd) && !error && POSIX_IsWrite(req))
+        error = errno;
+    req->error = error;
+    delete op;
+
+    m_lock.unlock();
+    if(req->callback)
+        req->callback(req);
+    m_lock.lock();
+
+    --m_active;
+    if(!--m_outstanding)
+        m_idle.notify_all();
+}
+
+//
+// Advance an op by the result of its last step.
+//
+void POSIXIOUring::complete(posixioop_t *op, int res)
+{
+    hal_iorequest_t *const req = op->req;
+
+    if(res < 0)
+    {
+        if(res == -EINTR || res == -EAGAIN)
+        {
+            if(op->fd < 0)
+                open(op);
+            else
+                transfer(op);
+            return;
+        }
+        finish(op, -res);
+        return;
+    }
+
+    if(op->fd < 0)
+    {
+        op->fd = res;
+        if(req->op == HAL_IO_READFILE)
+        {
+            struct stat st;
+            if(fstat(op->fd, &st))
+            {
+                finish(op, errno);
+                return;
+            }
+            if(uint64_t(st.st_size) >= SIZE_MAX)
+            {
+                finish(op, EFBIG);
+                return;
+            }
+            // terminated, so that text can be parsed in place
+            op->size    = size_t(st.st_size);
+            req->buffer = emalloc(ebyte, op->size + 1);
+            req->size   = 0;
+        }
+    }
+    else
+    {
+        // a read of nothing is the end of the file
+        if(res == 0 && !POSIX_IsWrite(req))
+            op->size = req->transferred;
+        else if(res == 0)
+        {
+            finish(op, EIO);
+            return;
+        }
+        req->transferred += size_t(res);
+    }
+
+    if(!transfer(op))
+    {
+        if(req->op == HAL_IO_READFILE)
+        {
+            static_cast<ebyte *>(req->buffer)[req->transferred] = 0;
+            req->size = req->transferred;
+        }
+        finish(op, 0);
+    }
+}
+
+//
+// Body of the completion thread.
+//
+void POSIXIOUring::reaper()
+{
+    std::unique_lock lock(m_lock);
+    for(;;)
+    {
+        lock.unlock();
+        if(POSIX_IOUringEnter(m_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+            hal_platform.fatalError("POSIXIOUring::reaper: io_uring_enter failed (%d)", errno);
+        lock.lock();
+
+        unsigned int       head = *m_cqHead;
+        const unsigned int tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        for(; head != tail; head++)
+        {
+            const io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+            if(cqe.user_data)
+                complete(reinterpret_cast<posixioop_t *>(cqe.user_data), cqe.res);
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+        pump();
+        enter();
+
+        if(m_stopping && !m_outstanding)
+            return;
+    }
+}
+
+void POSIXIOUring::submit(hal_iorequest_t **requests, size_t count)
+{
+    std::lock_guard lock(m_lock);
+    for(size_t i = 0; i < count; i++)
+        m_queues[eclamp<int>(requests[i]->priority, 0, HAL_IOPRI_COUNT - 1)].push_back(requests[i]);
+    m_outstanding += count;
+
+    pump();
+    enter();
+}
+
+void POSIXIOUring::drain()
+{
+    std::unique_lock lock(m_lock);
+    m_idle.wait(lock, [this] { return m_outstanding == 0; });
+}
+
+static POSIXIOUring *posix_ring;
+
+static void POSIX_SubmitIO(hal_iorequest_t **requests, size_t count)
+{
+    posix_ring->submit(requests, count);
+}
+
+static void POSIX_DrainIO()
+{
+    posix_ring->drain();
+}
+
+static const char *POSIX_IOBackend()
+{
+    return "io_uring";
+}
+
+#endif
+
+//
+// Use io_uring where the kernel has it, and otherwise keep the default
+// thread pool.
+//
+void POSIX_InitAsyncIO()
+{
+#if defined(ELIB_IO_URING)
+    static POSIXIOUring ring;
+    if(!ring.init())
+        return;
+
+    posix_ring = &ring;
+    hal_asyncio.submit  = POSIX_SubmitIO;
+    hal_asyncio.drain   = POSIX_DrainIO;
+    hal_asyncio.backend = POSIX_IOBackend;
+#endif
+}
+
+#endif
+
+// EOF
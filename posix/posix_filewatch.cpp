@@ -0,0 +1,223 @@
+/*
+  ELib
+
+  POSIX File Change Notification Implementation
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__unix__) || defined(__linux__) || defined(__APPLE__)
+
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/inotify.h>
+#endif
+
+#include "../elib/elib.h"
+#include "../elib/qstring.h"
+#include "../hal/hal_filewatch.h"
+#include "posix_filewatch.h"
+
+//=============================================================================
+//
+// POSIX File Watch Implementation
+//
+// On Linux, inotify on the file's directory says when to look again; the file
+// itself is not watched, because saving by rename replaces it. Elsewhere, or
+// if inotify is unavailable, the file is polled. Either way the decision is
+// made by comparing stat results, so events that leave the file as it was
+// are not reported.
+//
+//=============================================================================
+
+struct posixfilestate_t
+{
+    bool   exists = false;
+    dev_t  dev    = 0;
+    ino_t  ino    = 0;
+    off_t  size   = 0;
+    time_t sec    = 0;
+    long   nsec   = 0;
+
+    bool operator == (const posixfilestate_t &other) const
+    {
+        return exists == other.exists && dev == other.dev && ino == other.ino && 
+               size == other.size && sec == other.sec && nsec == other.nsec;
+    }
+    bool operator != (const posixfilestate_t &other) const { return !(*this == other); }
+};
+
+struct hal_watch_t : public EPoolAllocated
+{
+    qstring          m_path;
+    qstring          m_name;      // file name within its directory
+    posixfilestate_t m_state;     // as of the last reported change
+    int              m_fd = -1;   // inotify instance, or -1 when polling
+};
+
+//
+// Capture the identity, size and modification time of a file.
+//
+static posixfilestate_t POSIX_StatFile(const char *path)
+{
+    posixfilestate_t state;
+    struct stat st;
+
+    if(!stat(path, &st))
+    {
+        state.exists = true;
+        state.dev    = st.st_dev;
+        state.ino    = st.st_ino;
+        state.size   = st.st_size;
+        state.sec    = st.st_mtime;
+#if defined(__APPLE__)
+        state.nsec   = st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+        state.nsec   = st.st_mtim.tv_nsec;
+#endif
+    }
+
+    return state;
+}
+
+#if defined(__linux__)
+//
+// Drain pending inotify events, returning true if any concern the file.
+//
+static bool POSIX_DrainEvents(hal_watch_t *watch)
+{
+    alignas(struct inotify_event) char buf[4096];
+    bool relevant = false;
+    ssize_t len;
+
+    while((len = read(watch->m_fd, buf, sizeof(buf))) > 0)
+    {
+        for(const char *p = buf; p < buf + len; )
+        {
+            const auto event = reinterpret_cast<const struct inotify_event *>(p);
+            if((event->mask & IN_Q_OVERFLOW) || (event->len && watch->m_name == event->name))
+                relevant = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return relevant;
+}
+
+//
+// Set up inotify on the directory holding the file; on failure the watch is
+// left polling.
+//
+static void POSIX_StartNotify(hal_watch_t *watch)
+{
+    const char *const path  = watch->m_path.c_str();
+    const char *const slash = std::strrchr(path, '/');
+
+    qstring dir;
+    if(slash)
+        dir.copy(path, slash == path ? 1 : size_t(slash - path));
+    else
+        dir = ".";
+    watch->m_name = slash ? slash + 1 : path;
+
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0)
+        return;
+
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB;
+    if(inotify_add_watch(fd, dir.c_str(), mask) < 0)
+    {
+        close(fd);
+        return;
+    }
+
+    watch->m_fd = fd;
+}
+#endif
+
+//
+// Begin watching a file.
+//
+static struct hal_watch_t *POSIX_WatchFile(const char *path)
+{
+    hal_watch_t *const watch = ecnew<hal_watch_t>();
+    watch->m_path  = path;
+    watch->m_state = POSIX_StatFile(path);
+
+#if defined(__linux__)
+    POSIX_StartNotify(watch);
+#endif
+
+    return watch;
+}
+
+//
+// Check for a change to a watched file.
+//
+static hal_bool POSIX_FileChanged(struct hal_watch_t *watch)
+{
+    if(watch == nullptr)
+        return HAL_FALSE;
+
+#if defined(__linux__)
+    if(watch->m_fd >= 0 && !POSIX_DrainEvents(watch))
+        return HAL_FALSE;
+#endif
+
+    const posixfilestate_t state = POSIX_StatFile(watch->m_path.c_str());
+    if(state == watch->m_state)
+        return HAL_FALSE;
+
+    watch->m_state = state;
+    return HAL_TRUE;
+}
+
+//
+// Stop watching and free the watch.
+//
+static void POSIX_CloseWatch(struct hal_watch_t *watch)
+{
+    if(watch == nullptr)
+        return;
+
+    if(watch->m_fd >= 0)
+        close(watch->m_fd);
+
+    delete watch;
+}
+
+//
+// Load POSIX implementation function pointers into the hal_filewatch interface
+//
+void POSIX_InitFileWatch()
+{
+    hal_filewatch.watchFile   = POSIX_WatchFile;
+    hal_filewatch.fileChanged = POSIX_FileChanged;
+    hal_filewatch.closeWatch  = POSIX_CloseWatch;
+}
+
+#endif
+
+// EOF
@@ -44,7 +44,7 @@ struct hal_direntry_t
     struct dirent *m_pent = nullptr;
 };
 
-struct hal_dir_t
+struct hal_dir_t : public EPoolAllocated
 {
     hal_direntry_t m_ent;
     DIR *m_dir = nullptr;
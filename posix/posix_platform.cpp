@@ -28,7 +28,11 @@
 
 #if defined(__unix__) || defined(__linux__) || defined(__APPLE__)
 
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -40,6 +44,8 @@
 #include "../hal/hal_opendir.h"
 #include "../hal/hal_platform.h"
 #include "../hal/hal_video.h"
+#include "posix_asyncio.h"
+#include "posix_filewatch.h"
 #include "posix_opendir.h"
 #include "posix_platform.h"
 
@@ -143,6 +149,101 @@ static hal_bool POSIX_FileExists(const char *path)
     return (!stat(normpath.c_str(), &st) && !S_ISDIR(st.st_mode)) ? HAL_TRUE : HAL_FALSE;
 }
 
+//
+// Get the size and modification time of a regular file
+//
+static hal_bool POSIX_FileStat(const char *path, uint64_t *size, int64_t *mtime)
+{
+    struct stat st;
+    if(stat(path, &st) || !S_ISREG(st.st_mode))
+        return HAL_FALSE;
+
+    *size  = uint64_t(st.st_size);
+#if defined(__APPLE__)
+    *mtime = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    *mtime = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    *mtime = int64_t(st.st_mtime) * 1000000000;
+#endif
+    return HAL_TRUE;
+}
+
+//
+// Write a file atomically: the data goes to a temporary file beside it, which
+// is synced and then renamed over the original, and the directory is synced
+// so that the rename itself survives a crash. The replacement takes the mode
+// and, where permitted, the owner of the file it replaces.
+//
+static hal_bool POSIX_WriteFileAtomic(const char *path, const void *data, size_t size)
+{
+    qstring tmpPath { path };
+    tmpPath += ".tmp";
+
+    struct stat st;
+    const bool  replacing = !stat(path, &st) && S_ISREG(st.st_mode);
+
+    // a replacement is created private, so it is never more open than the
+    // original, even briefly
+    const int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, replacing ? 0600 : 0666);
+    if(fd < 0)
+        return HAL_FALSE;
+
+    const char *p    = static_cast<const char *>(data);
+    size_t      left = size;
+    bool        ok   = true;
+
+    if(replacing)
+    {
+        // the owner is set first, as changing it clears set-id bits; only
+        // privileged processes may give a file away, so failing to is not
+        // an error
+        if((st.st_uid != geteuid() || st.st_gid != getegid()) && fchown(fd, st.st_uid, st.st_gid) && errno != EPERM)
+            ok = false;
+        if(fchmod(fd, st.st_mode & 07777))
+            ok = false;
+    }
+
+    while(ok && left)
+    {
+        const ssize_t written = write(fd, p, left);
+        if(written < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            ok = false;
+            break;
+        }
+        p    += written;
+        left -= size_t(written);
+    }
+
+    if(ok && fsync(fd))
+        ok = false;
+    if(close(fd))
+        ok = false;
+
+    if(!ok || rename(tmpPath.c_str(), path))
+    {
+        unlink(tmpPath.c_str());
+        return HAL_FALSE;
+    }
+
+    qstring dir { path };
+    if(dir.findLastOf('/') == qstring::npos)
+        dir = ".";
+    else if(dir.removeFileSpec().empty())
+        dir = "/";
+
+    if(const int dirfd = open(dir.c_str(), O_RDONLY | O_CLOEXEC); dirfd >= 0)
+    {
+        fsync(dirfd);
+        close(dirfd);
+    }
+
+    return HAL_TRUE;
+}
+
 //
 // Check if a directory exists
 //
@@ -155,6 +256,56 @@ static hal_bool POSIX_DirectoryExists(const char *path)
     return (!stat(normpath.c_str(), &st) && S_ISDIR(st.st_mode)) ? HAL_TRUE : HAL_FALSE;
 }
 
+//
+// Map a regular file read-only. The descriptor is not needed once the mapping
+// exists. The data is terminated unless it exactly fills its pages: the last
+// page is made a private copy and cleared past the end of the file, so that
+// the file growing while mapped cannot write over the terminator. The file
+// must not be truncated while mapped.
+//
+static const void *POSIX_MapFile(const char *path, size_t *size, hal_bool *terminated)
+{
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return nullptr;
+
+    void *data = nullptr;
+    struct stat st;
+
+    if(!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        const size_t length   = size_t(st.st_size);
+        const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+        const size_t tail     = length % pageSize;
+        const int    prot     = tail ? PROT_READ | PROT_WRITE : PROT_READ;
+
+        if(void *const map = mmap(nullptr, length, prot, MAP_PRIVATE, fd, 0); map != MAP_FAILED)
+        {
+            if(tail)
+            {
+                memset(static_cast<ebyte *>(map) + length, 0, pageSize - tail);
+                mprotect(map, length, PROT_READ);
+            }
+            madvise(map, length, MADV_SEQUENTIAL);
+
+            data        = map;
+            *size       = length;
+            *terminated = tail ? HAL_TRUE : HAL_FALSE;
+        }
+    }
+
+    close(fd);
+    return data;
+}
+
+//
+// Release a mapping made by POSIX_MapFile.
+//
+static void POSIX_UnmapFile(const void *data, size_t size)
+{
+    munmap(const_cast<void *>(data), size);
+}
+
 //
 // Populate the HAL platform interface with POSIX implementation function pointers
 //
@@ -168,9 +319,15 @@ void POSIX_InitHAL(void)
     hal_platform.fileExists       = POSIX_FileExists;
     hal_platform.directoryExists  = POSIX_DirectoryExists;
     hal_platform.makeDirectory    = POSIX_MakeDirectory;
+    hal_platform.mapFile          = POSIX_MapFile;
+    hal_platform.unmapFile        = POSIX_UnmapFile;
+    hal_platform.fileStat         = POSIX_FileStat;
+    hal_platform.writeFileAtomic  = POSIX_WriteFileAtomic;
 
     // initialize opendir interface
     POSIX_InitOpenDir();
+    POSIX_InitFileWatch();
+    POSIX_InitAsyncIO();
 }
 
 #endif
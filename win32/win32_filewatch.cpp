@@ -0,0 +1,162 @@
+/*
+  ELib
+
+  Win32 File Change Notification Implementation
+
+  The MIT License (MIT)
+
+  Copyright (C) 2026 James Haley
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "../elib/elib.h"
+#include "../hal/hal_filewatch.h"
+#include "win32_util.h"
+#include "win32_filewatch.h"
+
+//=============================================================================
+//
+// Win32 File Watch Implementation
+//
+// A change notification on the file's directory says when to look again; if
+// one cannot be had, the file is polled. Either way the decision is made by
+// comparing the file's attributes, so unrelated changes in the directory are
+// not reported.
+//
+//=============================================================================
+
+struct win32filestate_t
+{
+    bool     exists    = false;
+    FILETIME writeTime = {};
+    DWORD    sizeHigh  = 0;
+    DWORD    sizeLow   = 0;
+
+    bool operator == (const win32filestate_t &other) const
+    {
+        return exists == other.exists && sizeHigh == other.sizeHigh && sizeLow == other.sizeLow &&
+               !CompareFileTime(&writeTime, &other.writeTime);
+    }
+};
+
+struct hal_watch_t
+{
+    std::wstring     m_path;
+    win32filestate_t m_state;                             // as of the last reported change
+    HANDLE           m_notify = INVALID_HANDLE_VALUE;     // directory notification, if any
+};
+
+//
+// Capture the size and modification time of a file.
+//
+static win32filestate_t Win32_StatFile(const std::wstring &path)
+{
+    win32filestate_t          state;
+    WIN32_FILE_ATTRIBUTE_DATA data;
+
+    if(GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+    {
+        state.exists    = true;
+        state.writeTime = data.ftLastWriteTime;
+        state.sizeHigh  = data.nFileSizeHigh;
+        state.sizeLow   = data.nFileSizeLow;
+    }
+
+    return state;
+}
+
+//
+// Begin watching a file, with the path assumed to be UTF-8.
+//
+static struct hal_watch_t *Win32_WatchFile(const char *path)
+{
+    hal_watch_t *const watch = ecnew<hal_watch_t>();
+    watch->m_path  = Win32_UTF8ToWStr(path);
+    watch->m_state = Win32_StatFile(watch->m_path);
+
+    // a separator is kept where it names a root, as in "\x.cfg" or "C:\x.cfg";
+    // without it, "C:" would be the current directory on that drive
+    std::wstring dir { watch->m_path };
+    if(const size_t sep = dir.find_last_of(L"\\/"); sep != std::wstring::npos)
+        dir.erase((sep == 0 || (sep == 2 && dir[1] == L':')) ? sep + 1 : sep);
+    else
+        dir = L".";
+
+    watch->m_notify = FindFirstChangeNotificationW(dir.c_str(), FALSE,
+                                                   FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                                                   FILE_NOTIFY_CHANGE_LAST_WRITE);
+    return watch;
+}
+
+//
+// Check for a change to a watched file.
+//
+static hal_bool Win32_FileChanged(struct hal_watch_t *watch)
+{
+    if(watch == nullptr)
+        return HAL_FALSE;
+
+    if(watch->m_notify != INVALID_HANDLE_VALUE)
+    {
+        if(WaitForSingleObject(watch->m_notify, 0) != WAIT_OBJECT_0)
+            return HAL_FALSE;
+        FindNextChangeNotification(watch->m_notify);
+    }
+
+    const win32filestate_t state = Win32_StatFile(watch->m_path);
+    if(state == watch->m_state)
+        return HAL_FALSE;
+
+    watch->m_state = state;
+    return HAL_TRUE;
+}
+
+//
+// Stop watching and free the watch.
+//
+static void Win32_CloseWatch(struct hal_watch_t *watch)
+{
+    if(watch == nullptr)
+        return;
+
+    if(watch->m_notify != INVALID_HANDLE_VALUE)
+        FindCloseChangeNotification(watch->m_notify);
+
+    delete watch;
+}
+
+//
+// Load Win32 implementation function pointers into the hal_filewatch interface
+//
+void Win32_InitFileWatch()
+{
+    hal_filewatch.watchFile   = Win32_WatchFile;
+    hal_filewatch.fileChanged = Win32_FileChanged;
+    hal_filewatch.closeWatch  = Win32_CloseWatch;
+}
+
+#endif
+
+// EOF
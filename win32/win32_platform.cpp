@@ -30,6 +30,8 @@
 
 #include <string>
 
+#include <string.h>
+
 #define WIN32_LEAN_AND_MEAN
 #include <direct.h>
 #include <io.h>
@@ -45,6 +47,7 @@
 #include "../hal/hal_opendir.h"
 #include "../hal/hal_platform.h"
 #include "../hal/hal_video.h"
+#include "win32_filewatch.h"
 #include "win32_opendir.h"
 #include "win32_platform.h"
 #include "win32_util.h"
@@ -194,6 +197,128 @@ static hal_bool Win32_MakeDirectory(const char *path)
     return (CreateDirectoryW(wdir.c_str(), nullptr) == TRUE || GetLastError() == ERROR_ALREADY_EXISTS) ? HAL_TRUE : HAL_FALSE;
 }
 
+//
+// Get the size and modification time of a regular file, with the path assumed
+// to be UTF-8. FILETIME counts 100ns intervals from 1601; it is rebased to the
+// Unix epoch before scaling, which would otherwise overflow.
+//
+static hal_bool Win32_FileStat(const char *path, uint64_t *size, int64_t *mtime)
+{
+    constexpr int64_t epochDelta = 116444736000000000; // 100ns intervals from 1601 to 1970
+
+    const std::wstring        wpath { Win32_UTF8ToWStr(path) };
+    WIN32_FILE_ATTRIBUTE_DATA data;
+
+    if(!GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &data) ||
+       (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        return HAL_FALSE;
+
+    const uint64_t ticks = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+
+    *size  = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    *mtime = (int64_t(ticks) - epochDelta) * 100;
+    return HAL_TRUE;
+}
+
+//
+// Write a file atomically, with the path assumed to be UTF-8: the data goes to
+// a temporary file beside it, which is flushed and then moved over the
+// original, with the move itself written through before returning.
+//
+static hal_bool Win32_WriteFileAtomic(const char *path, const void *data, size_t size)
+{
+    const std::wstring wpath   { Win32_UTF8ToWStr(path) };
+    const std::wstring tmpPath { wpath + L".tmp" };
+
+    const HANDLE file = CreateFileW(tmpPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return HAL_FALSE;
+
+    const char *p    = static_cast<const char *>(data);
+    size_t      left = size;
+    bool        ok   = true;
+
+    while(left && ok)
+    {
+        const DWORD chunk = left > 0x40000000 ? 0x40000000 : DWORD(left);
+        DWORD       written = 0;
+        if(!WriteFile(file, p, chunk, &written, nullptr) || !written)
+            ok = false;
+        p    += written;
+        left -= written;
+    }
+
+    if(ok && !FlushFileBuffers(file))
+        ok = false;
+    CloseHandle(file);
+
+    if(!ok || !MoveFileExW(tmpPath.c_str(), wpath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        DeleteFileW(tmpPath.c_str());
+        return HAL_FALSE;
+    }
+
+    return HAL_TRUE;
+}
+
+//
+// Map a file read-only, with the path assumed to be UTF-8. Neither the file
+// nor the mapping handle is needed once the view exists. The data is
+// terminated unless it exactly fills its pages: the view is copy-on-write, and
+// its last page is made a private copy and cleared past the end of the file,
+// so that the file growing while mapped cannot write over the terminator.
+//
+static const void *Win32_MapFile(const char *path, size_t *size, hal_bool *terminated)
+{
+    const std::wstring wpath { Win32_UTF8ToWStr(path) };
+    const HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    const void   *data = nullptr;
+    LARGE_INTEGER fileSize;
+
+    if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 &&
+       static_cast<unsigned long long>(fileSize.QuadPart) <= SIZE_MAX)
+    {
+        if(const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr); mapping)
+        {
+            data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            CloseHandle(mapping);
+
+            if(data)
+            {
+                SYSTEM_INFO si;
+                GetSystemInfo(&si);
+
+                const size_t length = size_t(fileSize.QuadPart);
+                const size_t tail   = length % si.dwPageSize;
+                DWORD        oldProtect;
+
+                if(tail)
+                    memset(static_cast<ebyte *>(const_cast<void *>(data)) + length, 0, si.dwPageSize - tail);
+                VirtualProtect(const_cast<void *>(data), length, PAGE_READONLY, &oldProtect);
+
+                *size       = length;
+                *terminated = tail ? HAL_TRUE : HAL_FALSE;
+            }
+        }
+    }
+
+    CloseHandle(file);
+    return data;
+}
+
+//
+// Release a view made by Win32_MapFile.
+//
+static void Win32_UnmapFile(const void *data, size_t)
+{
+    UnmapViewOfFile(data);
+}
+
 //
 // Populate the HAL platform interface with Win32 implementation function pointers
 //
@@ -207,9 +332,14 @@ void Win32_InitHAL()
     hal_platform.fileExists       = Win32_FileExists;
     hal_platform.directoryExists  = Win32_DirectoryExists;
     hal_platform.makeDirectory    = Win32_MakeDirectory;
+    hal_platform.mapFile          = Win32_MapFile;
+    hal_platform.unmapFile        = Win32_UnmapFile;
+    hal_platform.fileStat         = Win32_FileStat;
+    hal_platform.writeFileAtomic  = Win32_WriteFileAtomic;
 
     // initialize opendir interface
     Win32_InitOpenDir();
+    Win32_InitFileWatch();
 }
 
 #endif